@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <cobs/assembler.h>
+#include <cobs/stream.h>
+
+static struct cobs_frame *alloc_frame(struct cobs_frame_pool *pool)
+{
+	struct cobs_frame *frame;
+
+	if (k_mem_slab_alloc(pool->slab, (void **)&frame, K_NO_WAIT)) {
+		atomic_inc(&pool->exhausted);
+		return NULL;
+	}
+
+	const atomic_val_t num_free = k_mem_slab_num_free_get(pool->slab);
+	atomic_val_t min_free = atomic_get(&pool->min_free);
+
+	while (num_free < min_free && !atomic_cas(&pool->min_free, min_free, num_free)) {
+		min_free = atomic_get(&pool->min_free);
+	}
+
+	frame->pool = pool;
+	frame->length = 0;
+	return frame;
+}
+
+static void drop_frame(struct cobs_assembler *assembler, atomic_t *counter)
+{
+	atomic_inc(counter);
+	cobs_frame_free(assembler->frame);
+	assembler->frame = NULL;
+}
+
+void cobs_assembler_init(struct cobs_assembler *assembler, struct cobs_frame_pool *pool,
+			 struct k_fifo *fifo)
+{
+	*assembler = (struct cobs_assembler){
+		.pool = pool,
+		.fifo = fifo,
+		.frame = NULL,
+		.discard = false,
+	};
+	cobs_decode_reset(&assembler->decode);
+}
+
+size_t cobs_assembler_feed(struct cobs_assembler *assembler, const void *data, size_t length)
+{
+	struct cobs_frame_pool *const pool = assembler->pool;
+	const uint8_t *input = data;
+	size_t num_frames = 0;
+
+	while (length > 0) {
+		if (assembler->discard) {
+			const uint8_t *const zero = memchr(input, 0, length);
+			if (!zero) {
+				break;
+			}
+
+			length -= zero + 1 - input;
+			input = zero + 1;
+			assembler->discard = false;
+			continue;
+		}
+
+		if (!assembler->frame) {
+			/* Delimiters between frames. */
+			if (input[0] == 0) {
+				input++;
+				length--;
+				continue;
+			}
+
+			assembler->frame = alloc_frame(pool);
+			if (!assembler->frame) {
+				assembler->discard = true;
+				continue;
+			}
+
+			cobs_decode_reset(&assembler->decode);
+		}
+
+		struct cobs_frame *const frame = assembler->frame;
+		size_t num_read;
+		size_t num_written;
+
+		enum cobs_decode_result result = cobs_decode_stream(
+			&assembler->decode, input, length, &frame->data[frame->length],
+			pool->frame_size - frame->length, &num_read, &num_written);
+
+		input += num_read;
+		length -= num_read;
+		frame->length += num_written;
+
+		if (result == COBS_DECODE_RESULT_CONSUMED && length > 0) {
+			/* The block is full. The frame still fits if the next byte is
+			 * a code which doesn't add a zero, like a final 0x01.
+			 */
+			uint8_t output_byte;
+			bool output_available;
+
+			result = cobs_decode_stream_single(&assembler->decode, input[0], &output_byte,
+							   &output_available);
+			input++;
+			length--;
+
+			if (output_available) {
+				drop_frame(assembler, &pool->too_long);
+				assembler->discard = true;
+				continue;
+			}
+		}
+
+		switch (result) {
+		case COBS_DECODE_RESULT_CONSUMED:
+			break;
+
+		case COBS_DECODE_RESULT_FINISHED:
+			atomic_inc(&pool->frames);
+			k_fifo_put(assembler->fifo, frame);
+			assembler->frame = NULL;
+			num_frames++;
+			break;
+
+		case COBS_DECODE_RESULT_UNEXPECTED_ZERO:
+		case COBS_DECODE_RESULT_ERROR:
+		default:
+			drop_frame(assembler, &pool->invalid);
+			break;
+		}
+	}
+
+	return num_frames;
+}
+
+void cobs_assembler_reset(struct cobs_assembler *assembler)
+{
+	if (assembler->frame) {
+		cobs_frame_free(assembler->frame);
+		assembler->frame = NULL;
+	}
+
+	assembler->discard = false;
+}
+
+void cobs_frame_free(struct cobs_frame *frame)
+{
+	k_mem_slab_free(frame->pool->slab, frame);
+}
+
+void cobs_frame_pool_stats_get(struct cobs_frame_pool *pool, struct cobs_frame_pool_stats *stats)
+{
+	*stats = (struct cobs_frame_pool_stats){
+		.frames = atomic_get(&pool->frames),
+		.exhausted = atomic_get(&pool->exhausted),
+		.too_long = atomic_get(&pool->too_long),
+		.invalid = atomic_get(&pool->invalid),
+		.min_free = atomic_get(&pool->min_free),
+	};
+}
@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cobs.h>
+#include <cobs/batch.h>
+
+/* Encodes `msg` including the delimiter if it fits into `output_size` bytes. */
+static bool cobs_encode_batch_fitting(const struct cobs_batch_msg *msg, uint8_t *output,
+				      size_t output_size, size_t *num_written)
+{
+	struct cobs_encode_flat encode;
+
+	/* Every byte stays a byte, plus at least one code and the delimiter. */
+	if (msg->length + 2 > output_size) {
+		return false;
+	}
+
+	cobs_encode_flat_init(&encode, msg->data, msg->length);
+	*num_written = cobs_encode_flat(&encode, output, output_size);
+
+	return encode.state == COBS_ENCODE_FLAT_STATE_FINISHED;
+}
+
+size_t cobs_encode_batch(const struct cobs_batch_msg *msgs, size_t num_msgs, uint8_t *output,
+			 size_t output_size, size_t *num_written)
+{
+	size_t written = 0;
+	size_t i;
+
+	for (i = 0; i < num_msgs; i++) {
+		const struct cobs_batch_msg *const msg = &msgs[i];
+		const size_t left = output_size - written;
+
+		if (COBS_MAX_ENCODED_SIZE(msg->length) + 1 <= left) {
+			written += cobs_encode(msg->data, msg->length, &output[written]);
+			output[written++] = 0x00;
+			continue;
+		}
+
+		size_t msg_written;
+		if (!cobs_encode_batch_fitting(msg, &output[written], left, &msg_written)) {
+			break;
+		}
+
+		written += msg_written;
+	}
+
+	*num_written = written;
+	return i;
+}
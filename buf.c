@@ -0,0 +1,265 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <cobs.h>
+#include <cobs/scan.h>
+
+#if KERNEL_VERSION_NUMBER < 0x30100
+#include <sys/__assert.h>
+#else
+#include <zephyr/sys/__assert.h>
+#endif
+
+static size_t cobs_buf_cursor_span(struct cobs_encode_source *source, const uint8_t **data)
+{
+	struct cobs_buf_cursor *const cursor = CONTAINER_OF(source, struct cobs_buf_cursor, source);
+
+	while (cursor->buf && cursor->offset == cursor->buf->len) {
+		cursor->buf = cursor->buf->frags;
+		cursor->offset = 0;
+	}
+
+	if (!cursor->buf) {
+		return 0;
+	}
+
+	*data = cursor->buf->data + cursor->offset;
+	return cursor->buf->len - cursor->offset;
+}
+
+static void cobs_buf_cursor_advance(struct cobs_encode_source *source, size_t length)
+{
+	struct cobs_buf_cursor *const cursor = CONTAINER_OF(source, struct cobs_buf_cursor, source);
+
+	__ASSERT_NO_MSG(cursor->buf && cursor->offset + length <= cursor->buf->len);
+	cursor->offset += length;
+}
+
+static int cobs_buf_cursor_find_zero(struct cobs_encode_source *source, size_t max_length,
+				     size_t *offset)
+{
+	struct cobs_buf_cursor *const cursor = CONTAINER_OF(source, struct cobs_buf_cursor, source);
+	size_t num_processed = 0;
+
+	/* The fragments are kept alive by the reference to the head, so we
+	 * don't need to reference each of them.
+	 */
+	struct net_buf *buf = cursor->buf;
+	size_t start_offset = cursor->offset;
+	while (buf && num_processed < max_length) {
+		const uint8_t *const data = buf->data + start_offset;
+		const size_t length = MIN(buf->len - start_offset, max_length - num_processed);
+
+		const uint8_t *const zero = z_cobs_find_zero(data, length);
+		if (zero) {
+			*offset = num_processed + (size_t)(zero - data);
+			return 0;
+		}
+
+		num_processed += length;
+		buf = buf->frags;
+		start_offset = 0;
+	}
+
+	*offset = num_processed;
+	return -ENOENT;
+}
+
+static void cobs_buf_cursor_release(struct cobs_encode_source *source)
+{
+	struct cobs_buf_cursor *const cursor = CONTAINER_OF(source, struct cobs_buf_cursor, source);
+
+	if (cursor->head) {
+		net_buf_unref(cursor->head);
+		cursor->head = NULL;
+	}
+
+	cursor->buf = NULL;
+	cursor->offset = 0;
+}
+
+static const struct cobs_encode_source_api cobs_buf_cursor_api = {
+	.span = cobs_buf_cursor_span,
+	.advance = cobs_buf_cursor_advance,
+	.find_zero = cobs_buf_cursor_find_zero,
+	.release = cobs_buf_cursor_release,
+};
+
+void cobs_buf_cursor_init(struct cobs_buf_cursor *cursor, struct net_buf *buf)
+{
+	*cursor = (struct cobs_buf_cursor){
+		.source.api = &cobs_buf_cursor_api,
+		.head = net_buf_ref(buf),
+		.buf = buf,
+	};
+}
+
+void cobs_encode_stream_init(struct cobs_encode *encode, struct net_buf *buf)
+{
+	cobs_buf_cursor_init(&encode->cursor, buf);
+	cobs_encode_stream_init_source(encode, &encode->cursor.source);
+}
+
+size_t cobs_encode_stream_buf(struct cobs_encode *encode, struct net_buf *output,
+			      size_t reserved_tailroom)
+{
+	const size_t tailroom = net_buf_tailroom(output);
+	if (tailroom <= reserved_tailroom) {
+		return 0;
+	}
+
+	const size_t num_written =
+		cobs_encode_stream(encode, net_buf_tail(output), tailroom - reserved_tailroom);
+	net_buf_add(output, num_written);
+
+	return num_written;
+}
+
+void cobs_encode_zc_destroy(struct net_buf *buf)
+{
+	struct net_buf **const origin = net_buf_user_data(buf);
+
+	if (*origin) {
+		net_buf_unref(*origin);
+		*origin = NULL;
+	}
+
+	net_buf_destroy(buf);
+}
+
+struct cobs_encode_zc_chain {
+	struct net_buf_pool *pool;
+	k_timeout_t timeout;
+	struct net_buf *head;
+	struct net_buf *tail;
+};
+
+static void cobs_encode_zc_append(struct cobs_encode_zc_chain *chain, struct net_buf *buf,
+				  struct net_buf *origin)
+{
+	*(struct net_buf **)net_buf_user_data(buf) = origin;
+
+	if (chain->tail) {
+		net_buf_frag_insert(chain->tail, buf);
+	} else {
+		chain->head = buf;
+	}
+
+	chain->tail = buf;
+}
+
+static int cobs_encode_zc_add_code(struct cobs_encode_zc_chain *chain, uint8_t code)
+{
+	/* Codes of consecutive blocks without data share a buffer. */
+	if (chain->tail && !*(struct net_buf **)net_buf_user_data(chain->tail) &&
+	    net_buf_tailroom(chain->tail)) {
+		net_buf_add_u8(chain->tail, code);
+		return 0;
+	}
+
+	struct net_buf *const buf = net_buf_alloc(chain->pool, chain->timeout);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	cobs_encode_zc_append(chain, buf, NULL);
+	net_buf_add_u8(buf, code);
+
+	return 0;
+}
+
+static int cobs_encode_zc_add_data(struct cobs_encode_zc_chain *chain, struct net_buf *origin,
+				   const uint8_t *data, size_t length)
+{
+	struct net_buf *const buf =
+		net_buf_alloc_with_data(chain->pool, (void *)data, length, chain->timeout);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	cobs_encode_zc_append(chain, buf, net_buf_ref(origin));
+
+	return 0;
+}
+
+int cobs_encode_zc(struct net_buf *input, struct net_buf_pool *pool, k_timeout_t timeout,
+		   struct net_buf **output)
+{
+	struct cobs_encode_zc_chain chain = {
+		.pool = pool,
+		.timeout = timeout,
+	};
+	struct cobs_buf_cursor cursor = {
+		.source.api = &cobs_buf_cursor_api,
+		.buf = input,
+	};
+	struct cobs_encode_source *const source = &cursor.source;
+	int ret;
+
+	for (;;) {
+		size_t block_length;
+		const uint8_t *data;
+
+		(void)source->api->find_zero(source, 254, &block_length);
+
+		const uint8_t code = block_length + 1;
+		ret = cobs_encode_zc_add_code(&chain, code);
+		if (ret) {
+			goto fail;
+		}
+
+		/* The head keeps all fragments of the input alive. */
+		while (block_length) {
+			const size_t length = MIN(source->api->span(source, &data), block_length);
+
+			ret = cobs_encode_zc_add_data(&chain, input, data, length);
+			if (ret) {
+				goto fail;
+			}
+
+			source->api->advance(source, length);
+			block_length -= length;
+		}
+
+		if (source->api->span(source, &data) == 0) {
+			break;
+		}
+
+		/* Blocks that are shorter than 254 bytes end with a zero. */
+		if (code != 0xFF) {
+			__ASSERT_NO_MSG(data[0] == 0);
+			source->api->advance(source, 1);
+		}
+	}
+
+	ret = cobs_encode_zc_add_code(&chain, 0x00);
+	if (ret) {
+		goto fail;
+	}
+
+	*output = chain.head;
+	return 0;
+
+fail:
+	if (chain.head) {
+		net_buf_unref(chain.head);
+	}
+
+	return ret;
+}
+
+int cobs_encode_buf(struct net_buf *output, const uint8_t *input, size_t length,
+		    size_t reserved_tailroom)
+{
+	if (net_buf_tailroom(output) < COBS_MAX_ENCODED_SIZE(length) + reserved_tailroom) {
+		return -ENOMEM;
+	}
+
+	const size_t encoded_length = cobs_encode(input, length, net_buf_tail(output));
+	net_buf_add(output, encoded_length);
+
+	return 0;
+}
@@ -5,9 +5,45 @@
  */
 
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <cobs.h>
+#include <cobs/scan.h>
 
+#ifdef CONFIG_COBS_PROFILE_SPEED
+size_t cobs_encode(const uint8_t *restrict input, size_t length, uint8_t *restrict output)
+{
+	size_t read_index = 0;
+	size_t write_index = 0;
+
+	for (;;) {
+		/* Empty blocks are common and not worth a call into libc. */
+		while (read_index < length && input[read_index] == 0) {
+			output[write_index++] = 1;
+			read_index++;
+		}
+
+		const size_t max_length = MIN(length - read_index, 254);
+		const size_t block_length = z_cobs_copy_nonzero(&output[write_index + 1],
+								&input[read_index], max_length);
+
+		output[write_index] = block_length + 1;
+		write_index += block_length + 1;
+		read_index += block_length;
+
+		if (read_index == length) {
+			return write_index;
+		}
+
+		/* Blocks that are shorter than 254 bytes end with a zero. */
+		if (block_length != 254) {
+			read_index++;
+		}
+	}
+}
+#else
 size_t cobs_encode(const uint8_t *restrict input, size_t length, uint8_t *restrict output)
 {
 	size_t read_index = 0;
@@ -41,7 +77,75 @@ size_t cobs_encode(const uint8_t *restrict input, size_t length, uint8_t *restri
 
 	return write_index;
 }
+#endif /* CONFIG_COBS_PROFILE_SPEED */
+
+#if defined(CONFIG_COBS_PROFILE_SPEED) || defined(CONFIG_COBS_PROFILE_SIZE)
+/* Shared by cobs_decode and cobs_decode_inplace. The output never overtakes
+ * the input, so this works in-place as well.
+ */
+static int cobs_decode_common(const uint8_t *input, size_t length, uint8_t *output,
+			      size_t *decoded_size)
+{
+	size_t read_index = 0;
+	size_t write_index = 0;
+
+	while (read_index < length) {
+		const uint8_t code = input[read_index];
+		if (code == 0) {
+			return -EINVAL;
+		}
+
+		if (read_index + code > length && code != 1) {
+			return -EINVAL;
+		}
+
+		read_index++;
+
+#ifdef CONFIG_COBS_PROFILE_SPEED
+		/* Empty blocks are common and not worth a call into libc. */
+		const size_t data_length = code - 1;
+		if (data_length != 0) {
+			if (z_cobs_copy_nonzero(&output[write_index], &input[read_index],
+						data_length) != data_length) {
+				return -EINVAL;
+			}
+
+			read_index += data_length;
+			write_index += data_length;
+		}
+#else
+		for (uint8_t i = 1; i < code; i++) {
+			const uint8_t byte = input[read_index++];
+			if (byte == 0) {
+				return -EINVAL;
+			}
+
+			output[write_index++] = byte;
+		}
+#endif
+
+		if (code != 0xFF && read_index != length) {
+			output[write_index++] = '\0';
+		}
+	}
+
+	*decoded_size = write_index;
+	return 0;
+}
 
+int cobs_decode(const uint8_t *restrict input, size_t length, uint8_t *restrict output,
+		size_t *decoded_size)
+{
+	return cobs_decode_common(input, length, output, decoded_size);
+}
+
+#ifdef CONFIG_COBS_DECODE_INPLACE
+int cobs_decode_inplace(uint8_t *data, size_t max_length, size_t *decoded_size)
+{
+	return cobs_decode_common(data, max_length, data, decoded_size);
+}
+#endif
+#else
 int cobs_decode(const uint8_t *restrict input, size_t length, uint8_t *restrict output,
 		size_t *decoded_size)
 {
@@ -80,6 +184,7 @@ int cobs_decode(const uint8_t *restrict input, size_t length, uint8_t *restrict
 	return 0;
 }
 
+#ifdef CONFIG_COBS_DECODE_INPLACE
 int cobs_decode_inplace(uint8_t *data, size_t max_length, size_t *decoded_size)
 {
 	size_t read_index = 0;
@@ -116,3 +221,38 @@ int cobs_decode_inplace(uint8_t *data, size_t max_length, size_t *decoded_size)
 	*decoded_size = write_index;
 	return 0;
 }
+#endif
+#endif /* CONFIG_COBS_PROFILE_SPEED || CONFIG_COBS_PROFILE_SIZE */
+
+int cobs_decode_runs_next(struct cobs_decode_runs *runs, const uint8_t **run, size_t *run_length,
+			  bool *followed_by_zero)
+{
+	const size_t read_index = runs->read_index;
+	const size_t length = runs->length;
+
+	if (read_index >= length) {
+		return 0;
+	}
+
+	const uint8_t code = runs->input[read_index];
+	if (code == 0) {
+		return -EINVAL;
+	}
+
+	if (read_index + code > length && code != 1) {
+		return -EINVAL;
+	}
+
+	const uint8_t *const data = &runs->input[read_index + 1];
+	if (z_cobs_find_zero(data, code - 1)) {
+		return -EINVAL;
+	}
+
+	runs->read_index = read_index + code;
+
+	*run = data;
+	*run_length = code - 1;
+	*followed_by_zero = code != 0xFF && runs->read_index != length;
+
+	return 1;
+}
@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cobs/cut_through.h>
+#include <cobs/stream.h>
+
+int cobs_cut_through_init(struct cobs_cut_through *cut, uint8_t *buffer, size_t size,
+			  size_t prefix_length, cobs_cut_through_cb_t cb)
+{
+	if (size == 0 || size < prefix_length) {
+		return -EINVAL;
+	}
+
+	*cut = (struct cobs_cut_through){
+		.cb = cb,
+		.buffer = buffer,
+		.size = size,
+		.prefix_length = prefix_length,
+		.length = 0,
+		.started = false,
+		.prefix_done = false,
+	};
+	cobs_decode_reset(&cut->decode);
+
+	return 0;
+}
+
+static void deliver(struct cobs_cut_through *cut, enum cobs_cut_through_event event)
+{
+	cut->cb(cut, event, cut->buffer, cut->length);
+	cut->length = 0;
+}
+
+static void end_frame(struct cobs_cut_through *cut, enum cobs_cut_through_event event)
+{
+	if (event == COBS_CUT_THROUGH_ABORT) {
+		cut->length = 0;
+	}
+
+	deliver(cut, event);
+
+	cut->started = false;
+	cut->prefix_done = false;
+	cobs_decode_reset(&cut->decode);
+}
+
+void cobs_cut_through_feed(struct cobs_cut_through *cut, const void *data, size_t length)
+{
+	const uint8_t *input = data;
+
+	while (length > 0) {
+		/* Delimiters between frames. */
+		if (!cut->started && input[0] == 0) {
+			input++;
+			length--;
+			continue;
+		}
+
+		if (cut->length == cut->size) {
+			deliver(cut, COBS_CUT_THROUGH_DATA);
+		}
+
+		/* Stop decoding at the end of the prefix to deliver it right
+		 * away.
+		 */
+		const size_t limit = cut->prefix_done ? cut->size : cut->prefix_length;
+		size_t num_read;
+		size_t num_written;
+
+		const enum cobs_decode_result result =
+			cobs_decode_stream(&cut->decode, input, length, &cut->buffer[cut->length],
+					   limit - cut->length, &num_read, &num_written);
+
+		input += num_read;
+		length -= num_read;
+		cut->length += num_written;
+		cut->started = true;
+
+		if (!cut->prefix_done && cut->length == cut->prefix_length) {
+			deliver(cut, COBS_CUT_THROUGH_PREFIX);
+			cut->prefix_done = true;
+		}
+
+		switch (result) {
+		case COBS_DECODE_RESULT_CONSUMED:
+			break;
+
+		case COBS_DECODE_RESULT_FINISHED:
+			end_frame(cut, COBS_CUT_THROUGH_END);
+			break;
+
+		case COBS_DECODE_RESULT_UNEXPECTED_ZERO:
+		case COBS_DECODE_RESULT_ERROR:
+		default:
+			end_frame(cut, COBS_CUT_THROUGH_ABORT);
+			break;
+		}
+	}
+
+	if (cut->prefix_done && cut->length > 0) {
+		deliver(cut, COBS_CUT_THROUGH_DATA);
+	}
+}
+
+void cobs_cut_through_reset(struct cobs_cut_through *cut)
+{
+	if (cut->started) {
+		end_frame(cut, COBS_CUT_THROUGH_ABORT);
+	}
+}
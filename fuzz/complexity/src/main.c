@@ -0,0 +1,442 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Looks for inputs which make encoding or decoding slow.
+ *
+ * Every input is encoded and decoded with all implementations, in chunks of
+ * CONFIG_FUZZ_COMPLEXITY_CHUNK_SIZE bytes for the streaming ones. All budgets
+ * are counted exactly, so they don't depend on the load of the host:
+ * - The streaming encoder reads its data through a source which counts all
+ *   work it causes, and every single call has to stay within a budget that's
+ *   linear in the number of bytes it wrote.
+ * - The other streaming APIs have to make progress with every call, and may
+ *   only take CONFIG_FUZZ_COMPLEXITY_CALLS_PER_FRAME calls per frame besides
+ *   one per chunk. cobs_decode_stream may read at most its chunk and write at
+ *   most what it read.
+ * - The run iterator has to return the runs one after the other, without
+ *   reading any byte twice.
+ *
+ * cobs_encode, cobs_decode and cobs_decode_inplace are single calls whose
+ * work can't be observed. Like all other paths, they are measured with the
+ * host clock, which is too noisy for a budget. Instead, the worst ratio of
+ * time or work per byte of every path is reported to libFuzzer as coverage,
+ * so it keeps inputs that make a path slower than all previous inputs did.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <zephyr/irq.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+#include <cobs.h>
+#include <cobs/stream.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(fuzz, LOG_LEVEL_DBG);
+
+#define MAX_INPUT_SIZE 4096
+#define CHUNK_SIZE     CONFIG_FUZZ_COMPLEXITY_CHUNK_SIZE
+
+/* Encoders may look up to 254 bytes ahead to find the code of a block. */
+#define LOOKAHEAD 254
+
+#define NUM_BUCKETS 16
+
+#define CALLS_PER_FRAME CONFIG_FUZZ_COMPLEXITY_CALLS_PER_FRAME
+
+static uint8_t encoded[COBS_MAX_ENCODED_SIZE(MAX_INPUT_SIZE) + 1];
+static size_t encoded_size;
+static uint8_t output[COBS_MAX_ENCODED_SIZE(MAX_INPUT_SIZE) + 1];
+
+struct measurement {
+	/* Worst time per byte of a single call, in 1/16 ns. */
+	uint64_t worst_rate;
+};
+
+struct path {
+	const char *name;
+	void (*run)(struct measurement *m, const uint8_t *input, size_t input_size);
+};
+
+enum {
+	PATH_ENCODE,
+	PATH_ENCODE_STREAM,
+	PATH_ENCODE_FLAT,
+	PATH_ENCODE_APPEND,
+	PATH_DECODE,
+	PATH_DECODE_INPLACE,
+	PATH_DECODE_RUNS,
+	PATH_DECODE_STREAM,
+	PATH_DECODE_STREAM_VALID,
+	NUM_PATHS,
+};
+
+/* Every path gets a set of buckets for time and the streaming encoder another
+ * one for its exact work. libFuzzer treats these like coverage counters.
+ */
+static uint8_t extra_counters[NUM_PATHS + 1][NUM_BUCKETS] __used
+	Z_GENERIC_SECTION(__libfuzzer_extra_counters);
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void record(struct measurement *m, const size_t size, const uint64_t ns)
+{
+	m->worst_rate = MAX(m->worst_rate, ns * 16 / (size + 1));
+}
+
+/* Measures one call which processes `size` bytes. */
+#define TIMED(m, size, call)                                                                       \
+	do {                                                                                       \
+		const uint64_t start_ = now_ns();                                                  \
+		call;                                                                              \
+		record(m, size, now_ns() - start_);                                                \
+	} while (0)
+
+/* Fails the input if `value` exceeds `budget`. */
+static void check_budget(const char *path, const char *what, size_t value, size_t budget,
+			 const uint8_t *input, size_t input_size)
+{
+	if (value <= budget) {
+		return;
+	}
+
+	LOG_ERR("%s: %s %zu is over the budget of %zu", path, what, value, budget);
+	LOG_HEXDUMP_DBG(input, input_size, "input");
+	__ASSERT_NO_MSG(false);
+}
+
+static size_t bucket(uint64_t value)
+{
+	size_t index = 0;
+
+	while (value > 1 && index < NUM_BUCKETS - 1) {
+		value >>= 1;
+		index += 1;
+	}
+
+	return index;
+}
+
+/* Source for the streaming encoder which counts the work it causes. */
+struct counting_source {
+	struct cobs_encode_source source;
+	struct cobs_mem_source mem;
+	size_t work;
+};
+
+static size_t counting_span(struct cobs_encode_source *source, const uint8_t **data)
+{
+	struct counting_source *const counting =
+		CONTAINER_OF(source, struct counting_source, source);
+
+	counting->work += 1;
+	return counting->mem.source.api->span(&counting->mem.source, data);
+}
+
+static void counting_advance(struct cobs_encode_source *source, size_t length)
+{
+	struct counting_source *const counting =
+		CONTAINER_OF(source, struct counting_source, source);
+
+	counting->work += 1 + length;
+	counting->mem.source.api->advance(&counting->mem.source, length);
+}
+
+static int counting_find_zero(struct cobs_encode_source *source, size_t max_length,
+			      size_t *offset)
+{
+	struct counting_source *const counting =
+		CONTAINER_OF(source, struct counting_source, source);
+
+	const int ret = counting->mem.source.api->find_zero(&counting->mem.source, max_length,
+							    offset);
+	counting->work += 1 + *offset + (ret == 0 ? 1 : 0);
+
+	return ret;
+}
+
+static const struct cobs_encode_source_api counting_api = {
+	.span = counting_span,
+	.advance = counting_advance,
+	.find_zero = counting_find_zero,
+};
+
+static void run_encode(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	TIMED(m, input_size, encoded_size = cobs_encode(input, input_size, encoded));
+	encoded[encoded_size] = 0x00;
+}
+
+static void run_encode_stream(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	struct counting_source source = {
+		.source.api = &counting_api,
+	};
+	struct cobs_encode encode;
+	size_t total = 0;
+	size_t nbytes;
+
+	cobs_mem_source_init(&source.mem, input, input_size);
+	cobs_encode_stream_init_source(&encode, &source.source);
+
+	do {
+		const size_t work_before = source.work;
+
+		TIMED(m, CHUNK_SIZE + LOOKAHEAD,
+		      nbytes = cobs_encode_stream(&encode, &output[total], CHUNK_SIZE));
+		total += nbytes;
+
+		/* The code of a block may be written by this call and its data
+		 * by the next one, so a call may scan up to LOOKAHEAD bytes it
+		 * didn't write yet.
+		 */
+		check_budget("encode_stream", "work of a call", source.work - work_before,
+			     CONFIG_FUZZ_COMPLEXITY_WORK_PER_BYTE * nbytes + LOOKAHEAD, input,
+			     input_size);
+	} while (nbytes);
+
+	cobs_encode_stream_free(&encode);
+
+	check_budget("encode_stream", "total work", source.work,
+		     CONFIG_FUZZ_COMPLEXITY_WORK_PER_BYTE * total, input, input_size);
+
+	extra_counters[NUM_PATHS][bucket(source.work * 16 / (total + 1))] = 1;
+}
+
+static void run_encode_flat(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	struct cobs_encode_flat encode;
+	size_t total = 0;
+	size_t calls = 0;
+	size_t nbytes;
+
+	cobs_encode_flat_init(&encode, input, input_size);
+
+	do {
+		TIMED(m, CHUNK_SIZE + LOOKAHEAD,
+		      nbytes = cobs_encode_flat(&encode, &output[total], CHUNK_SIZE));
+		total += nbytes;
+		calls++;
+	} while (nbytes);
+
+	check_budget("encode_flat", "calls", calls,
+		     DIV_ROUND_UP(total, CHUNK_SIZE) + CALLS_PER_FRAME, input, input_size);
+}
+
+static void run_encode_append(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	struct cobs_encode_append encode;
+	size_t total_read = 0;
+	size_t total_written = 0;
+	size_t calls = 0;
+	size_t nbytes;
+
+	cobs_encode_append_init(&encode);
+
+	while (total_read < input_size) {
+		size_t num_read;
+		size_t num_written;
+
+		TIMED(m, 2 * CHUNK_SIZE + LOOKAHEAD,
+		      cobs_encode_append(&encode, &input[total_read],
+					 MIN(CHUNK_SIZE, input_size - total_read),
+					 &output[total_written], CHUNK_SIZE, &num_read,
+					 &num_written));
+		total_read += num_read;
+		total_written += num_written;
+		calls++;
+
+		/* A call either consumes all of its input or fills its output. */
+		check_budget("encode_append", "calls", calls,
+			     DIV_ROUND_UP(input_size, CHUNK_SIZE) + total_written / CHUNK_SIZE,
+			     input, input_size);
+	}
+
+	do {
+		TIMED(m, CHUNK_SIZE + LOOKAHEAD,
+		      nbytes = cobs_encode_append_finish(&encode, &output[total_written],
+							 CHUNK_SIZE));
+		total_written += nbytes;
+		calls++;
+	} while (nbytes);
+
+	check_budget("encode_append", "calls", calls,
+		     DIV_ROUND_UP(input_size, CHUNK_SIZE) +
+			     DIV_ROUND_UP(total_written, CHUNK_SIZE) + CALLS_PER_FRAME,
+		     input, input_size);
+}
+
+static void run_decode(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	size_t decoded_size;
+	int ret;
+
+	/* Malformed data, which can fail early or late */
+	const uint8_t *const zero = memchr(input, 0, input_size);
+	const size_t length = zero ? (size_t)(zero - input) : input_size;
+	TIMED(m, length, ret = cobs_decode(input, length, output, &decoded_size));
+	ARG_UNUSED(ret);
+
+	TIMED(m, encoded_size, ret = cobs_decode(encoded, encoded_size, output, &decoded_size));
+	__ASSERT_NO_MSG(ret == 0 && decoded_size == input_size);
+}
+
+static void run_decode_inplace(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	size_t decoded_size;
+	int ret;
+
+	memcpy(output, encoded, encoded_size + 1);
+	TIMED(m, encoded_size, ret = cobs_decode_inplace(output, encoded_size, &decoded_size));
+	__ASSERT_NO_MSG(ret == 0 && decoded_size == input_size);
+}
+
+static void run_decode_runs(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	struct cobs_decode_runs runs;
+	const uint8_t *run;
+	size_t run_length;
+	bool followed_by_zero;
+	size_t read_index = 0;
+	int ret;
+
+	cobs_decode_runs_init(&runs, encoded, encoded_size);
+
+	do {
+		TIMED(m, LOOKAHEAD,
+		      ret = cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero));
+
+		if (ret > 0) {
+			/* Every run directly follows its code, which directly
+			 * follows the previous run.
+			 */
+			__ASSERT_NO_MSG(run == &encoded[read_index + 1]);
+			read_index += 1 + run_length;
+		}
+	} while (ret > 0);
+
+	__ASSERT_NO_MSG(ret == 0);
+	check_budget("decode_runs", "bytes read", read_index, encoded_size, input, input_size);
+}
+
+/* Like a UART RX handler, decode `data` in chunks and start a new frame at
+ * every delimiter or error.
+ */
+static void decode_stream(struct measurement *m, const uint8_t *data, size_t size)
+{
+	struct cobs_decode decode;
+	size_t total_read = 0;
+	size_t total_written = 0;
+	size_t calls = 0;
+	size_t frames = 0;
+
+	cobs_decode_reset(&decode);
+
+	while (total_read < size) {
+		const size_t chunk = MIN(CHUNK_SIZE, size - total_read);
+		enum cobs_decode_result result;
+		size_t num_read;
+		size_t num_written;
+
+		TIMED(m, CHUNK_SIZE,
+		      result = cobs_decode_stream(&decode, &data[total_read], chunk,
+						  &output[total_written],
+						  sizeof(output) - total_written, &num_read,
+						  &num_written));
+		total_read += num_read;
+		total_written += num_written;
+		calls++;
+
+		/* The output never runs out, so every call reads something. */
+		__ASSERT_NO_MSG(num_read > 0);
+		check_budget("decode_stream", "bytes read", num_read, chunk, data, size);
+		check_budget("decode_stream", "bytes written", num_written, num_read, data, size);
+
+		if (result != COBS_DECODE_RESULT_CONSUMED) {
+			cobs_decode_reset(&decode);
+			total_written = 0;
+			frames++;
+		}
+	}
+
+	/* A call only ends before its chunk does at the end of a frame. */
+	check_budget("decode_stream", "calls", calls,
+		     DIV_ROUND_UP(size, CHUNK_SIZE) + CALLS_PER_FRAME * frames, data, size);
+}
+
+static void run_decode_stream(struct measurement *m, const uint8_t *input, size_t input_size)
+{
+	decode_stream(m, input, input_size);
+}
+
+static void run_decode_stream_valid(struct measurement *m, const uint8_t *input,
+				    size_t input_size)
+{
+	decode_stream(m, encoded, encoded_size + 1);
+}
+
+/* Encoding has to run first, since the decoders use its output. */
+static const struct path paths[NUM_PATHS] = {
+	[PATH_ENCODE] = {"encode", run_encode},
+	[PATH_ENCODE_STREAM] = {"encode_stream", run_encode_stream},
+	[PATH_ENCODE_FLAT] = {"encode_flat", run_encode_flat},
+	[PATH_ENCODE_APPEND] = {"encode_append", run_encode_append},
+	[PATH_DECODE] = {"decode", run_decode},
+	[PATH_DECODE_INPLACE] = {"decode_inplace", run_decode_inplace},
+	[PATH_DECODE_RUNS] = {"decode_runs", run_decode_runs},
+	[PATH_DECODE_STREAM] = {"decode_stream", run_decode_stream},
+	[PATH_DECODE_STREAM_VALID] = {"decode_stream_valid", run_decode_stream_valid},
+};
+
+static void fuzzer_test_one_input(const uint8_t *const input, const size_t input_size)
+{
+	if (input_size > MAX_INPUT_SIZE) {
+		return;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(paths); i++) {
+		struct measurement m = {0};
+
+		paths[i].run(&m, input, input_size);
+		extra_counters[i][bucket(m.worst_rate)] = 1;
+	}
+}
+
+static K_SEM_DEFINE(fuzz_sem, 0, K_SEM_MAX_LIMIT);
+
+static void fuzz_isr(const void *arg)
+{
+	/* We could call check0() to execute the fuzz case here, but
+	 * pass it through to the main thread instead to get more OS
+	 * coverage.
+	 */
+	k_sem_give(&fuzz_sem);
+}
+
+int main(void)
+{
+	extern const uint8_t *posix_fuzz_buf;
+	extern size_t posix_fuzz_sz;
+
+	IRQ_CONNECT(CONFIG_ARCH_POSIX_FUZZ_IRQ, 0, fuzz_isr, NULL, 0);
+	irq_enable(CONFIG_ARCH_POSIX_FUZZ_IRQ);
+
+	while (true) {
+		k_sem_take(&fuzz_sem, K_FOREVER);
+
+		/* Execute the fuzz case we got from LLVM and passed
+		 * through an interrupt to this thread.
+		 */
+		fuzzer_test_one_input(posix_fuzz_buf, posix_fuzz_sz);
+	}
+
+	return 0;
+}
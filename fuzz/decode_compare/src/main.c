@@ -84,6 +84,41 @@ static int cobs_decode_inplace_withzero(uint8_t *const input, const size_t lengt
 	return cobs_decode_inplace(input, length - 1, decoded_size);
 }
 
+static int cobs_decode_runs_withzero(const uint8_t *const input, const size_t length,
+				     uint8_t *const output, size_t *const decoded_size)
+{
+	struct cobs_decode_runs runs;
+	const uint8_t *run;
+	size_t run_length;
+	bool followed_by_zero;
+	size_t output_length = 0;
+	int ret;
+
+	if (length == 0) {
+		return -EINVAL;
+	}
+	if (input[length - 1] != 0x00) {
+		return -EINVAL;
+	}
+
+	cobs_decode_runs_init(&runs, input, length - 1);
+	while ((ret = cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero)) == 1) {
+		memcpy(&output[output_length], run, run_length);
+		output_length += run_length;
+
+		if (followed_by_zero) {
+			output[output_length++] = 0x00;
+		}
+	}
+
+	if (ret) {
+		return ret;
+	}
+
+	*decoded_size = output_length;
+	return 0;
+}
+
 static void fuzzer_test_one_input(const uint8_t *const input, const size_t input_size)
 {
 	size_t decoded_size;
@@ -101,11 +136,21 @@ static void fuzzer_test_one_input(const uint8_t *const input, const size_t input
 	compare_result("stream", input, input_size, python_decoded, python_decoded_size, ret,
 		       decoded, decoded_size);
 
+	decoded_size = 0;
+	ret = cobs_decode_isr_simple(input, input_size, decoded, sizeof(decoded), &decoded_size);
+	compare_result("isr", input, input_size, python_decoded, python_decoded_size, ret, decoded,
+		       decoded_size);
+
 	decoded_size = 0;
 	ret = cobs_decode_withzero(input, input_size, decoded, &decoded_size);
 	compare_result("normal", input, input_size, python_decoded, python_decoded_size, ret,
 		       decoded, decoded_size);
 
+	decoded_size = 0;
+	ret = cobs_decode_runs_withzero(input, input_size, decoded, &decoded_size);
+	compare_result("runs", input, input_size, python_decoded, python_decoded_size, ret, decoded,
+		       decoded_size);
+
 	memcpy(decoded, input, input_size);
 
 	decoded_size = 0;
@@ -60,6 +60,16 @@ static void fuzzer_test_one_input(const uint8_t *const input, const size_t input
 	compare_result("stream", input, input_size, python_encoded, python_encoded_size, encoded,
 		       encoded_size - 1);
 
+	encoded_size = cobs_encode_flat_simple(input, input_size, encoded, sizeof(encoded),
+					       input_size % 300 + 1);
+	compare_result("flat", input, input_size, python_encoded, python_encoded_size, encoded,
+		       encoded_size - 1);
+
+	encoded_size = cobs_encode_append_simple(input, input_size, encoded, sizeof(encoded),
+						 input_size % 257 + 1, input_size % 13 + 1);
+	compare_result("append", input, input_size, python_encoded, python_encoded_size, encoded,
+		       encoded_size - 1);
+
 	encoded_size = cobs_encode(input, input_size, encoded);
 	__ASSERT_NO_MSG(encoded_size <= sizeof(encoded));
 	compare_result("normal", input, input_size, python_encoded, python_encoded_size, encoded,
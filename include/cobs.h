@@ -7,11 +7,19 @@
 #ifndef COBS_H_
 #define COBS_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include <cobs/stream.h>
 
+#ifdef __cplusplus
+extern "C" {
+#define Z_COBS_RESTRICT __restrict
+#else
+#define Z_COBS_RESTRICT restrict
+#endif
+
 #define Z_COBS_DIV_ROUND_UP(n, d)   (((n) + (d)-1) / (d))
 #define COBS_MAX_OVERHEAD(size)     MAX(1, Z_COBS_DIV_ROUND_UP((size), 254))
 #define COBS_MAX_ENCODED_SIZE(size) ((size) + COBS_MAX_OVERHEAD((size)))
@@ -20,11 +28,9 @@
  * Stuffs "length" bytes of data at the location pointed to by
  * "input", writing the output to the location pointed to by
  * "output". Returns the number of bytes written to "output".
- *
- * Remove the "restrict" qualifiers if compiling with a
- * pre-C99 C dialect.
  */
-size_t cobs_encode(const uint8_t *restrict input, size_t length, uint8_t *restrict output);
+size_t cobs_encode(const uint8_t *Z_COBS_RESTRICT input, size_t length,
+		   uint8_t *Z_COBS_RESTRICT output);
 
 /**
  * Unstuffs "length" bytes of data at the location pointed to by
@@ -32,13 +38,11 @@ size_t cobs_encode(const uint8_t *restrict input, size_t length, uint8_t *restri
  * "output". On success, returns 0 and writes the number of bytes
  * that were written to "output" to "decoded_size". On failure, it
  * returns a negative errno code.
- *
- * Remove the "restrict" qualifiers if compiling with a
- * pre-C99 C dialect.
  */
-int cobs_decode(const uint8_t *restrict input, size_t length, uint8_t *restrict output,
-		size_t *decoded_size);
+int cobs_decode(const uint8_t *Z_COBS_RESTRICT input, size_t length,
+		uint8_t *Z_COBS_RESTRICT output, size_t *decoded_size);
 
+#ifdef CONFIG_COBS_DECODE_INPLACE
 /**
  * Unstuffs "max_length" bytes of data at the location pointed to by
  * "data", in-place, over-writing the original.
@@ -46,6 +50,55 @@ int cobs_decode(const uint8_t *restrict input, size_t length, uint8_t *restrict
  * that were written to "data" to "decoded_size". On failure, it
  * returns a negative errno code.
  */
-int cobs_decode_inplace(uint8_t *restrict data, size_t max_length, size_t *decoded_size);
+int cobs_decode_inplace(uint8_t *Z_COBS_RESTRICT data, size_t max_length, size_t *decoded_size);
+#endif
+
+/**
+ * Iterator over the decoded data of an encoded buffer.
+ *
+ * Initialize it with #cobs_decode_runs_init and then call
+ * #cobs_decode_runs_next until it returns 0.
+ */
+struct cobs_decode_runs {
+	/** @internal The encoded data. */
+	const uint8_t *input;
+	/** @internal Size of `input`. */
+	size_t length;
+	/** @internal Offset of the next code. */
+	size_t read_index;
+};
+
+static inline void cobs_decode_runs_init(struct cobs_decode_runs *runs, const uint8_t *input,
+					 size_t length)
+{
+	*runs = (struct cobs_decode_runs){
+		.input = input,
+		.length = length,
+		.read_index = 0,
+	};
+}
+
+/**
+ * Get the next run of decoded data without copying or modifying anything.
+ *
+ * The encoded data passed to #cobs_decode_runs_init has the same format as
+ * for #cobs_decode. Its decoded data is made up of runs of non-zero bytes,
+ * each of which is either followed by a zero-byte or by the next run.
+ *
+ * On success, returns 1 and writes a pointer to the run within the encoded
+ * data to `run`, its (possibly zero) length to `run_length` and whether the
+ * decoded data has a zero-byte after it to `followed_by_zero`. Returns 0 when
+ * all data was consumed.
+ *
+ * The data is validated as it goes with the same rules as #cobs_decode, so it
+ * returns a negative errno code when it reaches malformed data. Runs which
+ * were returned before that are part of an invalid frame.
+ */
+int cobs_decode_runs_next(struct cobs_decode_runs *runs, const uint8_t **run, size_t *run_length,
+			  bool *followed_by_zero);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* COBS_H_ */
@@ -0,0 +1,306 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_HPP_
+#define COBS_HPP_
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <zephyr/sys/__assert.h>
+#include <cobs.h>
+
+namespace cobs
+{
+
+/** Maximum encoded size of `size` bytes of data, excluding the delimiter. */
+constexpr std::size_t max_encoded_size(const std::size_t size)
+{
+	return COBS_MAX_ENCODED_SIZE(size);
+}
+
+/**
+ * Encoded or decoded data with a compile-time capacity.
+ *
+ * Only the first `size()` bytes are valid. `status()` is 0 on success or a
+ * negative errno code if decoding failed, in which case `size()` is 0.
+ */
+template <std::size_t Capacity> struct frame {
+	std::array<std::uint8_t, Capacity> bytes{};
+	std::size_t length = 0;
+	int error = 0;
+
+	constexpr const std::uint8_t *data() const
+	{
+		return bytes.data();
+	}
+
+	constexpr std::size_t size() const
+	{
+		return length;
+	}
+
+	constexpr int status() const
+	{
+		return error;
+	}
+
+	constexpr const std::uint8_t *begin() const
+	{
+		return bytes.data();
+	}
+
+	constexpr const std::uint8_t *end() const
+	{
+		return bytes.data() + length;
+	}
+};
+
+namespace detail
+{
+
+constexpr bool is_constant_evaluated()
+{
+	return __builtin_is_constant_evaluated();
+}
+
+template <typename T> constexpr void check_byte_type()
+{
+	static_assert(std::is_integral_v<T> || std::is_same_v<T, std::byte>,
+		      "COBS data has to be made of bytes");
+}
+
+inline void byte_out_of_range()
+{
+	__ASSERT(false, "COBS data has to be in the range 0x00-0xFF");
+}
+
+/* Allows `std::array{1, 2, 3}` while still rejecting values that don't fit
+ * into a byte. Within constant expressions that's a compile error.
+ */
+template <typename T> constexpr std::uint8_t to_byte(const T value)
+{
+	if constexpr (std::is_integral_v<T> && sizeof(T) > 1) {
+		if (value < 0 || value > 0xFF) {
+			byte_out_of_range();
+		}
+	}
+
+	return static_cast<std::uint8_t>(value);
+}
+
+/* constexpr copies of the algorithms in cobs.c. They have to produce the exact
+ * same output because the runtime paths call into the C implementation.
+ */
+template <typename T>
+constexpr std::size_t encode(const T *const input, const std::size_t length,
+			     std::uint8_t *const output)
+{
+	std::size_t read_index = 0;
+	std::size_t write_index = 1;
+	std::size_t code_index = 0;
+	std::uint8_t code = 1;
+
+	while (read_index < length) {
+		const auto byte = to_byte(input[read_index++]);
+		if (byte == 0) {
+			output[code_index] = code;
+			code = 1;
+			code_index = write_index++;
+		} else {
+			output[write_index++] = byte;
+			code++;
+			if (code == 0xFF) {
+				output[code_index] = code;
+
+				if (read_index == length) {
+					return write_index;
+				}
+
+				code = 1;
+				code_index = write_index++;
+			}
+		}
+	}
+
+	output[code_index] = code;
+
+	return write_index;
+}
+
+template <typename T>
+constexpr int decode(const T *const input, const std::size_t length, std::uint8_t *const output,
+		     std::size_t *const decoded_size)
+{
+	std::size_t read_index = 0;
+	std::size_t write_index = 0;
+
+	while (read_index < length) {
+		const auto code = to_byte(input[read_index]);
+		if (code == 0) {
+			return -EINVAL;
+		}
+
+		if (read_index + code > length && code != 1) {
+			return -EINVAL;
+		}
+
+		read_index++;
+
+		for (std::uint8_t i = 1; i < code; i++) {
+			const auto byte = to_byte(input[read_index++]);
+			if (byte == 0) {
+				return -EINVAL;
+			}
+
+			output[write_index++] = byte;
+		}
+
+		if (code != 0xFF && read_index != length) {
+			output[write_index++] = '\0';
+		}
+	}
+
+	*decoded_size = write_index;
+	return 0;
+}
+
+} // namespace detail
+
+/** Exact encoded size of `input`, excluding the delimiter. */
+template <typename T, std::size_t N>
+constexpr std::size_t encoded_size(const std::array<T, N> &input)
+{
+	std::size_t size = 1;
+	std::size_t block = 0;
+
+	for (std::size_t i = 0; i < N; i++) {
+		if (detail::to_byte(input[i]) == 0) {
+			size += 1;
+			block = 0;
+			continue;
+		}
+
+		size += 1;
+		block += 1;
+		if (block == 254 && i + 1 != N) {
+			size += 1;
+			block = 0;
+		}
+	}
+
+	return size;
+}
+
+/**
+ * Encode `input`, excluding the delimiter.
+ *
+ * Usable in constant expressions. At runtime this calls #cobs_encode.
+ */
+template <typename T, std::size_t N>
+constexpr frame<max_encoded_size(N)> encode(const std::array<T, N> &input)
+{
+	detail::check_byte_type<T>();
+
+	frame<max_encoded_size(N)> output;
+
+	if constexpr (std::is_same_v<T, std::uint8_t>) {
+		if (!detail::is_constant_evaluated()) {
+			output.length = cobs_encode(input.data(), N, output.bytes.data());
+		} else {
+			output.length = detail::encode(input.data(), N, output.bytes.data());
+		}
+	} else {
+		output.length = detail::encode(input.data(), N, output.bytes.data());
+	}
+
+	return output;
+}
+
+/**
+ * Decode `input`, which must not contain the delimiter.
+ *
+ * Usable in constant expressions. At runtime this calls #cobs_decode.
+ */
+template <typename T, std::size_t N>
+constexpr frame<N> decode(const std::array<T, N> &input)
+{
+	detail::check_byte_type<T>();
+
+	frame<N> output;
+	int ret = 0;
+
+	if constexpr (std::is_same_v<T, std::uint8_t>) {
+		if (!detail::is_constant_evaluated()) {
+			ret = cobs_decode(input.data(), N, output.bytes.data(), &output.length);
+		} else {
+			ret = detail::decode(input.data(), N, output.bytes.data(), &output.length);
+		}
+	} else {
+		ret = detail::decode(input.data(), N, output.bytes.data(), &output.length);
+	}
+
+	if (ret) {
+		output.length = 0;
+		output.error = ret;
+	}
+
+	return output;
+}
+
+#if __cplusplus >= 202002L
+
+/**
+ * Compile-time data for #encode_constant.
+ *
+ * Can be created from a string literal, in which case the terminating NUL is
+ * not part of the data, or from a `std::array` of bytes.
+ */
+template <std::size_t N> struct literal {
+	std::array<std::uint8_t, N> bytes{};
+
+	constexpr literal(const char (&str)[N + 1])
+	{
+		for (std::size_t i = 0; i < N; i++) {
+			bytes[i] = static_cast<std::uint8_t>(str[i]);
+		}
+	}
+
+	template <typename T> constexpr literal(const std::array<T, N> &array)
+	{
+		detail::check_byte_type<T>();
+
+		for (std::size_t i = 0; i < N; i++) {
+			bytes[i] = detail::to_byte(array[i]);
+		}
+	}
+};
+
+template <std::size_t N> literal(const char (&)[N]) -> literal<N - 1>;
+template <typename T, std::size_t N> literal(const std::array<T, N> &) -> literal<N>;
+
+/**
+ * Encode `Input` at compile time into an array of the exact encoded size.
+ *
+ * If `Delimiter` is true, the 0x00 frame delimiter is appended so the result
+ * is ready to be sent as-is.
+ */
+template <literal Input, bool Delimiter = false> consteval auto encode_constant()
+{
+	constexpr frame<max_encoded_size(Input.bytes.size())> encoded = encode(Input.bytes);
+
+	std::array<std::uint8_t, encoded.size() + (Delimiter ? 1 : 0)> output{};
+	for (std::size_t i = 0; i < encoded.size(); i++) {
+		output[i] = encoded.bytes[i];
+	}
+
+	return output;
+}
+
+#endif /* __cplusplus >= 202002L */
+
+} // namespace cobs
+
+#endif /* COBS_HPP_ */
@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_ASSEMBLER_H_
+#define COBS_ASSEMBLER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <cobs/stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct cobs_frame_pool;
+
+/** A decoded frame, stored within a block of a #cobs_frame_pool. */
+struct cobs_frame {
+	/** @internal Reserved for the k_fifo the frame is passed through. */
+	void *fifo_reserved;
+	/** @internal Pool the frame belongs to. */
+	struct cobs_frame_pool *pool;
+	/** Length of the decoded data. */
+	size_t length;
+	/** The decoded data. */
+	uint8_t data[];
+};
+
+/** Counters of a #cobs_frame_pool. */
+struct cobs_frame_pool_stats {
+	/** Frames which were passed to consumers. */
+	uint32_t frames;
+	/** Frames which were dropped because no block was free. */
+	uint32_t exhausted;
+	/** Frames which were dropped because they didn't fit into a block. */
+	uint32_t too_long;
+	/** Frames which were dropped because they were invalid. */
+	uint32_t invalid;
+	/** Lowest number of free blocks after an allocation. */
+	uint32_t min_free;
+};
+
+/** Blocks for decoded frames, defined with #COBS_FRAME_POOL_DEFINE. */
+struct cobs_frame_pool {
+	/** @internal Slab of the blocks. */
+	struct k_mem_slab *slab;
+	/** @internal Maximum length of a frame within a block. */
+	size_t frame_size;
+	/** @internal Counters of `struct cobs_frame_pool_stats`. */
+	atomic_t frames;
+	atomic_t exhausted;
+	atomic_t too_long;
+	atomic_t invalid;
+	atomic_t min_free;
+};
+
+/** Size of a block holding a decoded frame of up to `frame_size` bytes. */
+#define COBS_FRAME_BLOCK_SIZE(frame_size)                                                          \
+	ROUND_UP(sizeof(struct cobs_frame) + (frame_size), sizeof(void *))
+
+/**
+ * Define a pool of `_count` blocks for decoded frames of up to `_frame_size`
+ * bytes each.
+ *
+ * The pool can be shared between multiple assemblers.
+ */
+#define COBS_FRAME_POOL_DEFINE(_name, _frame_size, _count)                                         \
+	K_MEM_SLAB_DEFINE(_name##_slab, COBS_FRAME_BLOCK_SIZE(_frame_size), _count,               \
+			  sizeof(void *));                                                         \
+	struct cobs_frame_pool _name = {                                                           \
+		.slab = &_name##_slab,                                                             \
+		.frame_size = (_frame_size),                                                       \
+		.min_free = ATOMIC_INIT(_count),                                                   \
+	}
+
+/**
+ * Decodes a stream of frames directly into blocks of a #cobs_frame_pool and
+ * puts every complete frame into a k_fifo.
+ *
+ * Consumers take the frames out of the fifo with `k_fifo_get` and give them
+ * back with #cobs_frame_free once they are done, so the data is never copied
+ * after decoding.
+ */
+struct cobs_assembler {
+	/** @internal Decoder of the current frame. */
+	struct cobs_decode decode;
+	/** @internal Pool the frames are allocated from. */
+	struct cobs_frame_pool *pool;
+	/** @internal Where complete frames are put. */
+	struct k_fifo *fifo;
+	/** @internal Frame being decoded, NULL between frames. */
+	struct cobs_frame *frame;
+	/** @internal If true, the input is skipped up to the next zero-byte. */
+	bool discard;
+};
+
+/** Initialize the assembler. */
+void cobs_assembler_init(struct cobs_assembler *assembler, struct cobs_frame_pool *pool,
+			 struct k_fifo *fifo);
+
+/**
+ * Decode received data.
+ *
+ * All of `data` is consumed, and it may contain any number of frames or
+ * parts of them. Zero-bytes outside of frames are skipped. Frames are dropped
+ * and counted within the statistics of the pool if no block is free, if they
+ * don't fit into a block or if they are invalid.
+ *
+ * This never blocks, so it can be called from an ISR. An assembler must only
+ * be fed from one context at a time.
+ *
+ * Returns the number of frames which were put into the fifo.
+ */
+size_t cobs_assembler_feed(struct cobs_assembler *assembler, const void *data, size_t length);
+
+/**
+ * Drop the frame being decoded, e.g. after a receive error.
+ *
+ * The next non-zero byte starts a new frame.
+ */
+void cobs_assembler_reset(struct cobs_assembler *assembler);
+
+/** Give a frame taken out of the fifo back to its pool. */
+void cobs_frame_free(struct cobs_frame *frame);
+
+/** Read the counters of the pool. */
+void cobs_frame_pool_stats_get(struct cobs_frame_pool *pool, struct cobs_frame_pool_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_ASSEMBLER_H_ */
@@ -0,0 +1,44 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_BATCH_H_
+#define COBS_BATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A message to be encoded by #cobs_encode_batch. */
+struct cobs_batch_msg {
+	const void *data;
+	size_t length;
+};
+
+/**
+ * Encode as many messages as possible into one buffer.
+ *
+ * The messages are encoded in order, each followed by the zero-byte
+ * delimiter, until the next one doesn't fit into the rest of `output`
+ * anymore. Messages are never split, so `output` can be passed to a single
+ * DMA transfer as-is. Messages that fit even in the worst case are encoded
+ * with #cobs_encode, only the last one that may fit is encoded with a
+ * size-bounded encoder.
+ *
+ * Writes the number of bytes of `output` that hold frames to `num_written`.
+ * Data behind that may have been modified.
+ *
+ * Returns the number of messages that were fully encoded, which are the
+ * first ones of `msgs`. If that's 0 although `num_msgs` isn't, the first
+ * message doesn't fit into `output` at all and has to be sent with a
+ * streaming encoder.
+ */
+size_t cobs_encode_batch(const struct cobs_batch_msg *msgs, size_t num_msgs, uint8_t *output,
+			 size_t output_size, size_t *num_written);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_BATCH_H_ */
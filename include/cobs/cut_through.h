@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_CUT_THROUGH_H_
+#define COBS_CUT_THROUGH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cobs/stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum cobs_cut_through_event {
+	/** The first bytes of the frame, as many as the prefix length. */
+	COBS_CUT_THROUGH_PREFIX,
+	/** More bytes of the frame, following the prefix. */
+	COBS_CUT_THROUGH_DATA,
+	/** The frame is complete and valid. Carries its last bytes, if any. */
+	COBS_CUT_THROUGH_END,
+	/** The frame is invalid. Everything delivered of it must be discarded. */
+	COBS_CUT_THROUGH_ABORT,
+};
+
+struct cobs_cut_through;
+
+/**
+ * Receives the decoded data of a frame piece by piece.
+ *
+ * The data of all events of a frame concatenated is the frame. `data` is only
+ * valid during the call.
+ */
+typedef void (*cobs_cut_through_cb_t)(struct cobs_cut_through *cut,
+				      enum cobs_cut_through_event event, const uint8_t *data,
+				      size_t length);
+
+/**
+ * Streaming decoder which delivers frames while they are still being received.
+ *
+ * As soon as the prefix of a frame is decoded, e.g. a header with the
+ * destination of the frame, it is passed to the callback within the same
+ * call of #cobs_cut_through_feed, so forwarding can start before the rest of
+ * the frame arrived. The rest is passed on at the end of every call or when
+ * the buffer is full. Whether the frame was valid is only known once its
+ * delimiter was received, which ends the frame with COBS_CUT_THROUGH_END or
+ * COBS_CUT_THROUGH_ABORT.
+ *
+ * Frames which are shorter than the prefix are delivered with just
+ * COBS_CUT_THROUGH_END.
+ */
+struct cobs_cut_through {
+	/** @internal Decoder of the current frame. */
+	struct cobs_decode decode;
+	/** @internal Called for every event. */
+	cobs_cut_through_cb_t cb;
+	/** @internal Decoded data which wasn't delivered yet. */
+	uint8_t *buffer;
+	/** @internal Size of `buffer`. */
+	size_t size;
+	/** @internal Length of the prefix. */
+	size_t prefix_length;
+	/** @internal Number of bytes within `buffer`. */
+	size_t length;
+	/** @internal If true, bytes of the current frame were received. */
+	bool started;
+	/** @internal If true, the prefix of the current frame was delivered. */
+	bool prefix_done;
+};
+
+/**
+ * Initialize the decoder.
+ *
+ * `buffer` has to hold at least `prefix_length` bytes. A larger buffer leads
+ * to fewer calls of `cb`.
+ *
+ * Returns 0 on success or -EINVAL if the buffer is too small.
+ */
+int cobs_cut_through_init(struct cobs_cut_through *cut, uint8_t *buffer, size_t size,
+			  size_t prefix_length, cobs_cut_through_cb_t cb);
+
+/**
+ * Decode received data.
+ *
+ * All of `data` is consumed, and it may contain any number of frames or
+ * parts of them. Zero-bytes outside of frames are skipped.
+ */
+void cobs_cut_through_feed(struct cobs_cut_through *cut, const void *data, size_t length);
+
+/**
+ * Drop the frame being decoded, e.g. after a receive error.
+ *
+ * If bytes of it were received already, COBS_CUT_THROUGH_ABORT is signaled.
+ */
+void cobs_cut_through_reset(struct cobs_cut_through *cut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_CUT_THROUGH_H_ */
@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_FIXED_H_
+#define COBS_FIXED_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __ZEPHYR__
+#include <version.h>
+
+#if KERNEL_VERSION_NUMBER < 0x30100
+#include <toolchain.h>
+#else
+#include <zephyr/toolchain.h>
+#endif
+#else
+#include <cobs/host.h>
+#endif /* __ZEPHYR__ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @internal Fully unroll the following loop if its bound is a constant. */
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8)
+#define Z_COBS_FIXED_UNROLL _Pragma("GCC unroll 254")
+#else
+#define Z_COBS_FIXED_UNROLL
+#endif
+
+/** Largest size supported by the fixed-size encoders and decoders. */
+#define COBS_FIXED_MAX_SIZE 254
+
+/**
+ * Encoded size of a frame of `size` bytes, which is exact for sizes up to
+ * #COBS_FIXED_MAX_SIZE: such a frame always has one block more than it has
+ * zero-bytes, and every zero-byte is replaced by the code of the next block.
+ */
+#define COBS_FIXED_ENCODED_SIZE(size) ((size) + 1)
+
+/**
+ * Encode exactly `length` bytes, where `length` is a compile-time constant of
+ * at most #COBS_FIXED_MAX_SIZE.
+ *
+ * Produces the same output as #cobs_encode, which is always
+ * #COBS_FIXED_ENCODED_SIZE bytes long. Since there's only a single block
+ * code per zero-byte and no code can exceed 0xFF, the data is walked
+ * backwards without any branches on the output position, and the compiler
+ * unrolls the loop for a constant `length`.
+ */
+static ALWAYS_INLINE void cobs_encode_fixed(const uint8_t *input, size_t length, uint8_t *output)
+{
+	uint8_t code = 1;
+
+	Z_COBS_FIXED_UNROLL
+	for (size_t i = length; i > 0; i--) {
+		const uint8_t byte = input[i - 1];
+
+		output[i] = byte != 0 ? byte : code;
+		code = byte != 0 ? code + 1 : 1;
+	}
+
+	output[0] = code;
+}
+
+/**
+ * Decode exactly `length` bytes from #COBS_FIXED_ENCODED_SIZE bytes of
+ * `input`, where `length` is a compile-time constant of at most
+ * #COBS_FIXED_MAX_SIZE.
+ *
+ * Frames of another size are rejected, otherwise the validation is the same as
+ * for #cobs_decode. On success, returns 0. On failure, returns -EINVAL and
+ * the contents of `output` are undefined.
+ *
+ * `input` and `output` may be the same buffer for decoding in-place.
+ */
+static ALWAYS_INLINE int cobs_decode_fixed(const uint8_t *input, size_t length, uint8_t *output)
+{
+	size_t next_code = (size_t)input[0];
+	uint8_t zero = input[0] == 0;
+
+	Z_COBS_FIXED_UNROLL
+	for (size_t i = 1; i <= length; i++) {
+		const uint8_t byte = input[i];
+		const bool is_code = i == next_code;
+
+		zero |= byte == 0;
+		output[i - 1] = is_code ? 0 : byte;
+		next_code = is_code ? i + byte : next_code;
+	}
+
+	if (zero || next_code != length + 1) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/**
+ * Define `_name_encode` and `_name_decode` for frames of `_size` bytes.
+ *
+ * They call #cobs_encode_fixed and #cobs_decode_fixed with fixed-size arrays,
+ * so the compiler can check the buffer sizes and unroll the loops:
+ *
+ * @code{.c}
+ * COBS_FIXED_DEFINE(cobs_setpoint, sizeof(struct setpoint));
+ *
+ * uint8_t frame[COBS_FIXED_ENCODED_SIZE(sizeof(struct setpoint)) + 1];
+ *
+ * cobs_setpoint_encode((const uint8_t *)&setpoint, frame);
+ * frame[sizeof(frame) - 1] = 0x00;
+ * @endcode
+ */
+#define COBS_FIXED_DEFINE(_name, _size)                                                            \
+	static ALWAYS_INLINE void _name##_encode(                                                  \
+		const uint8_t input[(_size)], uint8_t output[COBS_FIXED_ENCODED_SIZE(_size)])      \
+	{                                                                                          \
+		cobs_encode_fixed(input, (_size), output);                                         \
+	}                                                                                          \
+	static ALWAYS_INLINE int _name##_decode(                                                   \
+		const uint8_t input[COBS_FIXED_ENCODED_SIZE(_size)], uint8_t output[(_size)])      \
+	{                                                                                          \
+		return cobs_decode_fixed(input, (_size), output);                                  \
+	}                                                                                          \
+	BUILD_ASSERT((_size) > 0 && (_size) <= COBS_FIXED_MAX_SIZE,                                \
+		     "COBS_FIXED_DEFINE only supports sizes up to COBS_FIXED_MAX_SIZE")
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_FIXED_H_ */
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * The few Zephyr utilities used by the library and its headers, so the parts
+ * which don't depend on kernel objects can be built on a host without Zephyr.
+ */
+
+#ifndef COBS_HOST_H_
+#define COBS_HOST_H_
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+#ifndef ALWAYS_INLINE
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#endif
+
+#ifndef likely
+#define likely(x)   (__builtin_expect((bool)!!(x), true) != 0L)
+#define unlikely(x) (__builtin_expect((bool)!!(x), false) != 0L)
+#endif
+
+#ifndef CONTAINER_OF
+#define CONTAINER_OF(ptr, type, field) ((type *)(((char *)(ptr)) - offsetof(type, field)))
+#endif
+
+#ifndef BUILD_ASSERT
+#ifdef __cplusplus
+#define BUILD_ASSERT(EXPR, MSG...) static_assert(EXPR, "" MSG)
+#else
+#define BUILD_ASSERT(EXPR, MSG...) _Static_assert(EXPR, "" MSG)
+#endif
+#endif
+
+#ifndef __ASSERT_NO_MSG
+#define __ASSERT_NO_MSG(test) assert(test)
+#endif
+
+#endif /* COBS_HOST_H_ */
@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_LOG_H_
+#define COBS_LOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct flash_area;
+
+/**
+ * Append-only log of records on flash, stored as COBS frames.
+ *
+ * The flash area is split into blocks of the size of the buffer passed to
+ * #cobs_log_init. Every block which is in use starts with a header frame
+ * holding the number of its first record, followed by one frame per record.
+ * Records never span blocks. The headers are the sparse index of the log:
+ * seeking to a record is a binary search over them followed by a scan for
+ * zero-bytes within one block, and so is recovering after a power loss.
+ *
+ * A write which was interrupted only loses the record being written. The rest
+ * of its block is left unused.
+ */
+struct cobs_log {
+	/** @internal The flash area holding the log. */
+	const struct flash_area *fa;
+	/** @internal Buffer of one block. */
+	uint8_t *buffer;
+	/** @internal Size of a block and of `buffer`. */
+	size_t block_size;
+	/** @internal Number of blocks within `fa`. */
+	size_t num_blocks;
+	/** @internal Write block size of the flash. */
+	size_t align;
+	/** @internal Block which is written to. */
+	size_t block;
+	/**
+	 * @internal Offset of the next write within `block`, 0 if `block`
+	 * has no header yet.
+	 */
+	size_t write_offset;
+	/** @internal Number of records within the log. */
+	uint32_t num_records;
+};
+
+/**
+ * Initialize the log, recovering its state from flash.
+ *
+ * Only the last block which is in use is read, apart from the binary search
+ * for it. Nothing is written.
+ *
+ * `buffer_size` is the size of a block, which must be a multiple of the
+ * write block size of the flash. The largest record which can be appended is
+ * about one frame header smaller.
+ *
+ * Returns 0 on success or a negative errno code.
+ */
+int cobs_log_init(struct cobs_log *log, const struct flash_area *fa, uint8_t *buffer,
+		  size_t buffer_size);
+
+/**
+ * Append a record.
+ *
+ * Returns 0 on success, -EMSGSIZE if the record can never fit into a block,
+ * -ENOSPC if the log is full or another negative errno code if writing to
+ * the flash failed.
+ */
+int cobs_log_append(struct cobs_log *log, const void *data, size_t length);
+
+/**
+ * Read record number `record`, counting from 0.
+ *
+ * Writes the length of the record to `length`. Returns 0 on success,
+ * -ENOENT if the record doesn't exist, -ENOMEM if it doesn't fit into
+ * `size` bytes, -EINVAL if it is corrupt or another negative errno code if
+ * reading the flash failed. On -ENOMEM, `length` is set anyway.
+ */
+int cobs_log_read(struct cobs_log *log, uint32_t record, void *data, size_t size,
+		  size_t *length);
+
+/** Number of records within the log. */
+static inline uint32_t cobs_log_count(const struct cobs_log *log)
+{
+	return log->num_records;
+}
+
+/**
+ * Erase all records.
+ *
+ * Returns 0 on success or a negative errno code.
+ */
+int cobs_log_clear(struct cobs_log *log);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_LOG_H_ */
@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_MUX_H_
+#define COBS_MUX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <cobs.h>
+#include <cobs/stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal Size of the header of a sub-frame: the channel and the flags,
+ * which are Z_COBS_MUX_FIRST, Z_COBS_MUX_LAST and the index of the sub-frame
+ * within its message in the upper four bits.
+ */
+#define Z_COBS_MUX_HEADER_SIZE 2
+
+/** @internal The sub-frame is the first one of its message. */
+#define Z_COBS_MUX_FIRST 0x01
+
+/** @internal The sub-frame is the last one of its message. */
+#define Z_COBS_MUX_LAST 0x02
+
+/** @internal Shift of the index of the sub-frame within the flags. */
+#define Z_COBS_MUX_INDEX_SHIFT 4
+
+/**
+ * Maximum size of a sub-frame, encoded and including its delimiter, with
+ * `fragment_size` bytes of a message.
+ */
+#define COBS_MUX_MAX_ENCODED_SIZE(fragment_size)                                                   \
+	(COBS_MAX_ENCODED_SIZE(Z_COBS_MUX_HEADER_SIZE + (fragment_size)) + 1)
+
+/** Sending side of a channel of a #cobs_mux. */
+struct cobs_mux_channel {
+	/** @internal Messages which weren't started yet. */
+	struct k_fifo fifo;
+	/** @internal The message being sent, `head` is NULL if there's none. */
+	struct cobs_buf_cursor cursor;
+	/** @internal Bytes of the message being sent which are left. */
+	size_t left;
+	/** @internal Index of the next sub-frame of the message. */
+	uint8_t index;
+};
+
+/** @internal Source of a sub-frame: its header and a part of a message. */
+struct cobs_mux_source {
+	struct cobs_encode_source source;
+	/** @internal The header. */
+	uint8_t header[Z_COBS_MUX_HEADER_SIZE];
+	/** @internal Bytes of the header which were consumed. */
+	uint8_t header_offset;
+	/** @internal The channel whose message is sent. */
+	struct cobs_mux_channel *channel;
+	/** @internal Bytes of the message left within the sub-frame. */
+	size_t left;
+};
+
+/**
+ * Sends the messages of multiple channels over one link, as frames.
+ *
+ * Messages are split into sub-frames of up to `fragment_size` bytes, each of
+ * which starts with a header naming its channel. Before every sub-frame, the
+ * channel with the highest priority which has data is picked, so a long
+ * message on a low-priority channel delays a message on a higher-priority
+ * channel by at most one sub-frame.
+ */
+struct cobs_mux {
+	/** @internal The channels, ordered by priority, the first one is the highest. */
+	struct cobs_mux_channel *channels;
+	/** @internal Number of `channels`. */
+	size_t num_channels;
+	/** @internal Maximum number of bytes of a message within a sub-frame. */
+	size_t fragment_size;
+	/** @internal Encoder of the current sub-frame. */
+	struct cobs_encode encode;
+	/** @internal Source of the current sub-frame. */
+	struct cobs_mux_source source;
+};
+
+/**
+ * Initialize the multiplexer.
+ *
+ * The index of a channel within `channels` is its ID on the link and its
+ * priority, 0 being the highest. There can be up to 256 channels.
+ *
+ * Returns 0 on success or -EINVAL.
+ */
+int cobs_mux_init(struct cobs_mux *mux, struct cobs_mux_channel *channels, size_t num_channels,
+		  size_t fragment_size);
+
+/**
+ * Queue a message on a channel.
+ *
+ * On success, the multiplexer takes over the reference to `buf`, which must
+ * not be within another list or queue, and releases it once the message was
+ * encoded. This never blocks, so it can be called from any thread or ISR.
+ *
+ * Returns 0 on success or -EINVAL if the channel doesn't exist.
+ */
+int cobs_mux_send(struct cobs_mux *mux, uint8_t channel, struct net_buf *buf);
+
+/**
+ * Encode the queued messages into `output`.
+ *
+ * Sub-frames are continued across calls, so `output` can be of any size.
+ * Must only be called from one context at a time.
+ *
+ * Returns the number of bytes written, which is 0 once nothing is queued.
+ */
+size_t cobs_mux_encode(struct cobs_mux *mux, uint8_t *output, size_t output_size);
+
+struct cobs_demux;
+
+/** Receives the complete messages of a #cobs_demux. */
+typedef void (*cobs_demux_cb_t)(struct cobs_demux *demux, uint8_t channel, const uint8_t *data,
+				size_t length);
+
+/** Receiving side of a channel of a #cobs_demux. */
+struct cobs_demux_channel {
+	/** Buffer for the message being reassembled. */
+	uint8_t *buffer;
+	/** Size of `buffer`, the largest message which can be received. */
+	size_t size;
+	/** @internal Number of bytes within `buffer`. */
+	size_t length;
+	/** @internal Index of the next sub-frame of the message. */
+	uint8_t index;
+	/** @internal If true, a message is being reassembled. */
+	bool active;
+};
+
+/** Initializer for a channel of a #cobs_demux with the array `_buffer`. */
+#define COBS_DEMUX_CHANNEL(_buffer)                                                                \
+	{                                                                                          \
+		.buffer = (_buffer), .size = sizeof(_buffer),                                      \
+	}
+
+/**
+ * Reassembles the messages sent by a #cobs_mux.
+ *
+ * Sub-frames are decoded directly into the buffer of their channel.
+ * Messages with a missing or invalid sub-frame or which don't fit into the
+ * buffer are dropped.
+ */
+struct cobs_demux {
+	/** @internal Decoder of the current sub-frame. */
+	struct cobs_decode decode;
+	/** @internal The channels. */
+	struct cobs_demux_channel *channels;
+	/** @internal Number of `channels`. */
+	size_t num_channels;
+	/** @internal Called for every complete message. */
+	cobs_demux_cb_t cb;
+	/** @internal Header of the current sub-frame. */
+	uint8_t header[Z_COBS_MUX_HEADER_SIZE];
+	/** @internal Bytes of `header` which were received. */
+	uint8_t header_length;
+	/** @internal If true, bytes of the current sub-frame were received. */
+	bool started;
+	/** @internal If true, the input is skipped up to the next zero-byte. */
+	bool discard;
+};
+
+/** Initialize the demultiplexer. */
+void cobs_demux_init(struct cobs_demux *demux, struct cobs_demux_channel *channels,
+		     size_t num_channels, cobs_demux_cb_t cb);
+
+/**
+ * Decode received data.
+ *
+ * All of `data` is consumed, and it may contain any number of sub-frames or
+ * parts of them. `cb` is called for every message which was completed.
+ */
+void cobs_demux_feed(struct cobs_demux *demux, const void *data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_MUX_H_ */
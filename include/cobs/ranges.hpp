@@ -0,0 +1,382 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_RANGES_HPP_
+#define COBS_RANGES_HPP_
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include <cobs.hpp>
+
+namespace cobs
+{
+
+/**
+ * Encode `input` into `output`, excluding the delimiter.
+ *
+ * `output` has to be at least #max_encoded_size bytes large. Returns the part
+ * of `output` that was written to.
+ */
+inline std::span<std::uint8_t> encode(const std::span<const std::uint8_t> input,
+				      const std::span<std::uint8_t> output)
+{
+	__ASSERT(output.size() >= max_encoded_size(input.size()),
+		 "output buffer too small: %zu < %zu", output.size(),
+		 max_encoded_size(input.size()));
+
+	return output.first(cobs_encode(input.data(), input.size(), output.data()));
+}
+
+/**
+ * Decode `input`, which must not contain the delimiter, into `output`.
+ *
+ * On success, returns 0 and sets `decoded` to the part of `output` that was
+ * written to. If `output` may be too small for the decoded data, -ENOBUFS is
+ * returned. Malformed data returns -EINVAL.
+ */
+inline int decode(const std::span<const std::uint8_t> input, const std::span<std::uint8_t> output,
+		  std::span<std::uint8_t> &decoded)
+{
+	const std::size_t max_decoded_size = input.empty() ? 0 : input.size() - 1;
+	if (output.size() < max_decoded_size) {
+		return -ENOBUFS;
+	}
+
+	std::size_t decoded_size;
+	const int ret = cobs_decode(input.data(), input.size(), output.data(), &decoded_size);
+	if (ret) {
+		return ret;
+	}
+
+	decoded = output.first(decoded_size);
+	return 0;
+}
+
+#ifdef CONFIG_COBS_DECODE_INPLACE
+/**
+ * Decode `data` in-place.
+ *
+ * On success, returns 0 and sets `decoded` to the decoded part of `data`.
+ */
+inline int decode_inplace(const std::span<std::uint8_t> data, std::span<std::uint8_t> &decoded)
+{
+	std::size_t decoded_size;
+	const int ret = cobs_decode_inplace(data.data(), data.size(), &decoded_size);
+	if (ret) {
+		return ret;
+	}
+
+	decoded = data.first(decoded_size);
+	return 0;
+}
+#endif
+
+/**
+ * Lazily encoded view of a range of bytes, excluding the delimiter.
+ *
+ * This produces the same bytes as #cobs_encode without any buffer. To find the
+ * length of a block, up to 254 bytes of the underlying range are looked at
+ * ahead of time, so it has to be a forward range.
+ */
+template <std::ranges::forward_range V>
+	requires std::ranges::view<V>
+class encode_view : public std::ranges::view_interface<encode_view<V>>
+{
+	using base_iterator = std::ranges::iterator_t<const V>;
+	using base_sentinel = std::ranges::sentinel_t<const V>;
+
+	V base_ = V();
+
+public:
+	class iterator
+	{
+		enum class state : std::uint8_t {
+			code,
+			data,
+			finished,
+		};
+
+		base_iterator current_{};
+		base_sentinel end_{};
+		std::uint8_t code_ = 0;
+		std::uint8_t data_left_ = 0;
+		/* The current block is followed by a zero in the input */
+		bool zero_ = false;
+		state state_ = state::finished;
+
+		void start_block()
+		{
+			std::uint8_t length = 0;
+
+			zero_ = false;
+			for (auto it = current_; it != end_ && length < 254; ++it, ++length) {
+				if (static_cast<std::uint8_t>(*it) == 0) {
+					zero_ = true;
+					break;
+				}
+			}
+
+			code_ = length + 1;
+			data_left_ = length;
+			state_ = state::code;
+		}
+
+		void end_block()
+		{
+			if (zero_) {
+				++current_;
+				start_block();
+			} else if (code_ == 0xFF && current_ != end_) {
+				start_block();
+			} else {
+				state_ = state::finished;
+			}
+		}
+
+	public:
+		using iterator_concept = std::forward_iterator_tag;
+		using value_type = std::uint8_t;
+		using difference_type = std::ptrdiff_t;
+
+		iterator() = default;
+
+		iterator(base_iterator begin, base_sentinel end)
+			: current_(std::move(begin)), end_(std::move(end))
+		{
+			start_block();
+		}
+
+		std::uint8_t operator*() const
+		{
+			if (state_ == state::code) {
+				return code_;
+			}
+
+			return static_cast<std::uint8_t>(*current_);
+		}
+
+		iterator &operator++()
+		{
+			if (state_ == state::data) {
+				++current_;
+				data_left_ -= 1;
+			} else {
+				state_ = state::data;
+			}
+
+			if (data_left_ == 0) {
+				end_block();
+			}
+
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			iterator old = *this;
+			++*this;
+			return old;
+		}
+
+		friend bool operator==(const iterator &a, const iterator &b)
+		{
+			if (a.state_ == state::finished || b.state_ == state::finished) {
+				return a.state_ == b.state_;
+			}
+
+			return a.current_ == b.current_ && a.state_ == b.state_;
+		}
+
+		friend bool operator==(const iterator &it, std::default_sentinel_t)
+		{
+			return it.state_ == state::finished;
+		}
+	};
+
+	encode_view() = default;
+
+	constexpr explicit encode_view(V base) : base_(std::move(base))
+	{
+	}
+
+	iterator begin() const
+	{
+		return iterator(std::ranges::begin(base_), std::ranges::end(base_));
+	}
+
+	std::default_sentinel_t end() const
+	{
+		return std::default_sentinel;
+	}
+};
+
+template <typename R> encode_view(R &&) -> encode_view<std::views::all_t<R>>;
+
+/**
+ * Lazily decoded view of a range of bytes.
+ *
+ * This wraps `struct cobs_decode`. Decoding stops at the first zero-byte, or
+ * at the end of the underlying range if there is none. Since decoding can
+ * fail, this is a single-pass range whose result can be checked with
+ * `status()` after iterating it: 0 if the data was valid or -EINVAL if not.
+ */
+template <std::ranges::input_range V>
+	requires std::ranges::view<V>
+class decode_view : public std::ranges::view_interface<decode_view<V>>
+{
+	using base_iterator = std::ranges::iterator_t<V>;
+	using base_sentinel = std::ranges::sentinel_t<V>;
+
+	V base_ = V();
+	base_iterator current_{};
+	struct cobs_decode decode_ = {};
+	std::uint8_t output_ = 0;
+	bool finished_ = false;
+	int status_ = 0;
+
+	void finish(const int status)
+	{
+		finished_ = true;
+		status_ = status;
+	}
+
+	void next()
+	{
+		const base_sentinel end = std::ranges::end(base_);
+
+		while (current_ != end) {
+			bool output_available;
+			const enum cobs_decode_result result = cobs_decode_stream_single(
+				&decode_, static_cast<std::uint8_t>(*current_), &output_,
+				&output_available);
+			++current_;
+
+			switch (result) {
+			case COBS_DECODE_RESULT_CONSUMED:
+				break;
+			case COBS_DECODE_RESULT_FINISHED:
+				finish(0);
+				return;
+			default:
+				finish(-EINVAL);
+				return;
+			}
+
+			if (output_available) {
+				return;
+			}
+		}
+
+		/* Without a delimiter, the data must end on a block boundary just
+		 * like with #cobs_decode.
+		 */
+		finish(decode_.state == COBS_DECODE_STATE_CODE ? 0 : -EINVAL);
+	}
+
+public:
+	class iterator
+	{
+		decode_view *parent_ = nullptr;
+
+	public:
+		using iterator_concept = std::input_iterator_tag;
+		using value_type = std::uint8_t;
+		using difference_type = std::ptrdiff_t;
+
+		iterator() = default;
+
+		explicit iterator(decode_view *parent) : parent_(parent)
+		{
+		}
+
+		std::uint8_t operator*() const
+		{
+			return parent_->output_;
+		}
+
+		iterator &operator++()
+		{
+			parent_->next();
+			return *this;
+		}
+
+		void operator++(int)
+		{
+			++*this;
+		}
+
+		bool finished() const
+		{
+			return parent_->finished_;
+		}
+
+		friend bool operator==(const iterator &it, std::default_sentinel_t)
+		{
+			return it.finished();
+		}
+	};
+
+	decode_view() = default;
+
+	constexpr explicit decode_view(V base) : base_(std::move(base))
+	{
+	}
+
+	/** Can only be called once. */
+	iterator begin()
+	{
+		current_ = std::ranges::begin(base_);
+		cobs_decode_reset(&decode_);
+		finished_ = false;
+		status_ = 0;
+
+		next();
+		return iterator(this);
+	}
+
+	std::default_sentinel_t end() const
+	{
+		return std::default_sentinel;
+	}
+
+	/** 0 if the data decoded so far is valid or -EINVAL if not. */
+	int status() const
+	{
+		return status_;
+	}
+};
+
+template <typename R> decode_view(R &&) -> decode_view<std::views::all_t<R>>;
+
+namespace detail
+{
+
+template <template <typename> typename View> struct adaptor {
+	template <std::ranges::viewable_range R> auto operator()(R &&range) const
+	{
+		return View<std::views::all_t<R>>(std::views::all(std::forward<R>(range)));
+	}
+
+	template <std::ranges::viewable_range R>
+	friend auto operator|(R &&range, const adaptor &self)
+	{
+		return self(std::forward<R>(range));
+	}
+};
+
+} // namespace detail
+
+/** Range adaptor for #encode_view, e.g. `bytes | cobs::encoded`. */
+inline constexpr detail::adaptor<encode_view> encoded;
+
+/** Range adaptor for #decode_view, e.g. `frame | cobs::decoded`. */
+inline constexpr detail::adaptor<decode_view> decoded;
+
+} // namespace cobs
+
+#endif /* COBS_RANGES_HPP_ */
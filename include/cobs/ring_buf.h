@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_RING_BUF_H_
+#define COBS_RING_BUF_H_
+
+#include <cobs/stream.h>
+
+#if KERNEL_VERSION_NUMBER < 0x30100
+#include <sys/ring_buffer.h>
+#else
+#include <zephyr/sys/ring_buffer.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Pass the data of `input` to the decoder.
+ *
+ * This works like #cobs_decode_stream, but reads straight from the memory of
+ * `input` using `ring_buf_get_claim`, including data that wraps around its
+ * end. Only the bytes that were consumed by the decoder are removed from
+ * `input`, so the rest can be passed to the decoder of the next frame.
+ *
+ * `num_written` is set to the number of bytes written to `output`.
+ *
+ * Must not be called while there's an unfinished get-claim on `input`.
+ */
+enum cobs_decode_result cobs_decode_ring_buf(struct cobs_decode *decode, struct ring_buf *input,
+					     uint8_t *output, size_t output_size,
+					     size_t *num_written);
+
+/**
+ * Encode more data into `output`.
+ *
+ * This works like #cobs_encode_stream, but writes straight into the memory of
+ * `output` using `ring_buf_put_claim`, including the space that wraps around
+ * its end.
+ *
+ * Returns the number of bytes added to `output`, which is `0` when there's no
+ * more data left to encode or no more space within `output`.
+ *
+ * Must not be called while there's an unfinished put-claim on `output`.
+ */
+size_t cobs_encode_ring_buf(struct cobs_encode *encode, struct ring_buf *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_RING_BUF_H_ */
@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_RTIO_H_
+#define COBS_RTIO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/rtio/rtio.h>
+#include <cobs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of an encoded frame of `length` bytes of data with its delimiter. */
+#define COBS_RTIO_ENCODED_SIZE(length) (COBS_MAX_ENCODED_SIZE(length) + 1)
+
+/** @internal State of an encoder defined by COBS_RTIO_ENCODER_DEFINE. */
+struct cobs_rtio_encoder_data {
+	uint8_t *buffer;
+	size_t size;
+};
+
+/** @internal */
+extern const struct rtio_iodev_api cobs_rtio_encoder_api;
+
+/**
+ * Define a processing stage which encodes frames of up to `max_length` bytes
+ * into a buffer of its own.
+ *
+ * It takes RTIO_OP_TX entries, see #cobs_rtio_prep_encode, and completes them
+ * right within the submission, without a thread or context switch. The result
+ * of the completion is the length of the frame with its delimiter, or
+ * -EMSGSIZE if the data was longer than `max_length`.
+ *
+ * A write of the frame, see #cobs_rtio_prep_write_frame, is prepared before
+ * the length of the frame is known. If it directly follows the encoding in a
+ * chain, its length is set to the one of the frame when the encoding
+ * completes. This makes chains like reading a sensor, encoding the data and
+ * writing it to a UART possible. The buffer holds a single frame, so only one
+ * such chain may be in flight per encoder.
+ */
+#define COBS_RTIO_ENCODER_DEFINE(name, max_length)                                                 \
+	static uint8_t name##_buffer[COBS_RTIO_ENCODED_SIZE(max_length)];                          \
+	static struct cobs_rtio_encoder_data name##_data = {                                       \
+		.buffer = name##_buffer,                                                           \
+		.size = sizeof(name##_buffer),                                                     \
+	};                                                                                         \
+	RTIO_IODEV_DEFINE(name, &cobs_rtio_encoder_api, &name##_data)
+
+/**
+ * Processing stage which decodes a frame.
+ *
+ * It takes RTIO_OP_TXRX entries, see #cobs_rtio_prep_decode, and completes
+ * them right within the submission. Zero-bytes in front of the frame are
+ * skipped and it ends at the next zero-byte or the end of the input. The
+ * result of the completion is the decoded length, or -EINVAL if the frame was
+ * empty or invalid, in which case the rest of the chain is canceled.
+ */
+extern struct rtio_iodev cobs_rtio_decoder;
+
+/** Prepare the encoding of `length` bytes of `input` by `encoder`. */
+static inline void cobs_rtio_prep_encode(struct rtio_sqe *sqe, const struct rtio_iodev *encoder,
+					 int8_t prio, const uint8_t *input, size_t length,
+					 void *userdata)
+{
+	rtio_sqe_prep_write(sqe, encoder, prio, (uint8_t *)input, length, userdata);
+}
+
+/**
+ * Prepare writing the frame of `encoder` to `iodev`. It has to directly follow
+ * the encoding in a chain.
+ */
+static inline void cobs_rtio_prep_write_frame(struct rtio_sqe *sqe, const struct rtio_iodev *iodev,
+					      int8_t prio, const struct rtio_iodev *encoder,
+					      void *userdata)
+{
+	const struct cobs_rtio_encoder_data *const data = encoder->data;
+
+	rtio_sqe_prep_write(sqe, iodev, prio, data->buffer, data->size, userdata);
+}
+
+/**
+ * Prepare the decoding of `length` bytes of `input` into `output`, which has
+ * to hold `length` bytes and must not overlap with `input`.
+ */
+static inline void cobs_rtio_prep_decode(struct rtio_sqe *sqe, int8_t prio, const uint8_t *input,
+					 size_t length, uint8_t *output, void *userdata)
+{
+	rtio_sqe_prep_transceive(sqe, &cobs_rtio_decoder, prio, (uint8_t *)input, output, length,
+				 userdata);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_RTIO_H_ */
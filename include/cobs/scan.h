@@ -0,0 +1,190 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Internal kernels for searching zero-bytes, shared by the encoders and
+ * decoders which process whole blocks.
+ *
+ * On Armv7E-M and Armv8-M with the DSP extension, like the Cortex-M4 and
+ * Cortex-M33, four bytes are tested at once with UADD8 and SEL. With
+ * CONFIG_COBS_WORD_SCAN, other little-endian targets test a machine word at
+ * once with plain integer arithmetic. Otherwise the C library is used.
+ */
+
+#ifndef COBS_SCAN_H_
+#define COBS_SCAN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __ZEPHYR__
+#include <version.h>
+
+#if KERNEL_VERSION_NUMBER < 0x30100
+#include <toolchain.h>
+#else
+#include <zephyr/toolchain.h>
+#endif
+#else
+#include <cobs/host.h>
+#endif /* __ZEPHYR__ */
+
+#if defined(CONFIG_COBS_ARM_DSP) && defined(__ARM_FEATURE_SIMD32) && !defined(__ARM_BIG_ENDIAN)
+#define Z_COBS_ARM_DSP 1
+#define Z_COBS_WORD_SCAN 1
+#elif defined(CONFIG_COBS_WORD_SCAN) && defined(__BYTE_ORDER__) &&                                 \
+	__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define Z_COBS_WORD_SCAN 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef Z_COBS_WORD_SCAN
+#ifdef Z_COBS_ARM_DSP
+/** @internal Aligned word of data which may be accessed as bytes as well. */
+typedef uint32_t __attribute__((may_alias)) z_cobs_word_t;
+
+/** @internal Unaligned word, Armv7-M and Armv8-M.main store these in one go. */
+typedef uint32_t __attribute__((may_alias, aligned(1))) z_cobs_unaligned_word_t;
+
+/** @internal Returns a mask with 0xFF for each zero-byte of `word`. */
+static ALWAYS_INLINE z_cobs_word_t z_cobs_zero_mask(z_cobs_word_t word)
+{
+	uint32_t mask;
+
+	/* Adding 0xFF to a byte carries, and sets its GE flag, unless the
+	 * byte is zero. SEL then takes 0x00 for these bytes and 0xFF for the
+	 * others.
+	 */
+	__asm__("uadd8 %0, %1, %2\n\t"
+		"sel %0, %3, %2"
+		: "=&r"(mask)
+		: "r"(word), "r"(0xFFFFFFFFU), "r"(0U)
+		: "cc");
+
+	return mask;
+}
+#else
+/** @internal Aligned word of data which may be accessed as bytes as well. */
+typedef unsigned long __attribute__((may_alias)) z_cobs_word_t;
+
+/** @internal Unaligned word, stored bytewise by targets which need that. */
+typedef unsigned long __attribute__((may_alias, aligned(1))) z_cobs_unaligned_word_t;
+
+/** @internal 0x01 in every byte of a word. */
+#define Z_COBS_WORD_ONES (~0UL / 0xFF)
+
+/**
+ * @internal Returns a mask with the top bit set for the first zero-byte of
+ * `word`. Bytes after it may be marked wrongly because of the borrow, so only
+ * the lowest bit is exact, which is all the callers need.
+ */
+static ALWAYS_INLINE z_cobs_word_t z_cobs_zero_mask(z_cobs_word_t word)
+{
+	return (word - Z_COBS_WORD_ONES) & ~word & (Z_COBS_WORD_ONES * 0x80);
+}
+#endif /* Z_COBS_ARM_DSP */
+
+/** @internal Index of the first zero-byte within a non-zero `mask`. */
+static ALWAYS_INLINE size_t z_cobs_zero_index(z_cobs_word_t mask)
+{
+	return (size_t)__builtin_ctzl(mask) / 8;
+}
+
+/** @internal Whether `data` is aligned for a z_cobs_word_t. */
+static ALWAYS_INLINE bool z_cobs_word_aligned(const uint8_t *data)
+{
+	return ((uintptr_t)data & (sizeof(z_cobs_word_t) - 1)) == 0;
+}
+#endif /* Z_COBS_WORD_SCAN */
+
+/** @internal Same as memchr(data, 0, length). */
+static ALWAYS_INLINE const uint8_t *z_cobs_find_zero(const uint8_t *data, size_t length)
+{
+#ifdef Z_COBS_WORD_SCAN
+	const uint8_t *const end = data + length;
+
+	while (data < end && !z_cobs_word_aligned(data)) {
+		if (*data == 0) {
+			return data;
+		}
+		data++;
+	}
+
+	for (; (size_t)(end - data) >= sizeof(z_cobs_word_t); data += sizeof(z_cobs_word_t)) {
+		const z_cobs_word_t mask = z_cobs_zero_mask(*(const z_cobs_word_t *)data);
+
+		if (mask != 0) {
+			return data + z_cobs_zero_index(mask);
+		}
+	}
+
+	for (; data < end; data++) {
+		if (*data == 0) {
+			return data;
+		}
+	}
+
+	return NULL;
+#else
+	return memchr(data, 0, length);
+#endif
+}
+
+/**
+ * @internal Copy up to `length` bytes from `input` to `output`, stopping in
+ * front of the first zero-byte. Returns the number of bytes copied.
+ *
+ * `output` may overlap `input` if it doesn't come after it, like when
+ * decoding in-place.
+ */
+static ALWAYS_INLINE size_t z_cobs_copy_nonzero(uint8_t *output, const uint8_t *input,
+						size_t length)
+{
+#ifdef Z_COBS_WORD_SCAN
+	size_t i = 0;
+
+	/* Align the loads, which are the ones that must not cross the end of
+	 * the input, the stores to the output may be unaligned.
+	 */
+	for (; i < length && !z_cobs_word_aligned(&input[i]); i++) {
+		if (input[i] == 0) {
+			return i;
+		}
+		output[i] = input[i];
+	}
+
+	for (; length - i >= sizeof(z_cobs_word_t); i += sizeof(z_cobs_word_t)) {
+		const z_cobs_word_t word = *(const z_cobs_word_t *)&input[i];
+
+		if (z_cobs_zero_mask(word) != 0) {
+			break;
+		}
+
+		*(z_cobs_unaligned_word_t *)&output[i] = word;
+	}
+
+	for (; i < length; i++) {
+		if (input[i] == 0) {
+			break;
+		}
+		output[i] = input[i];
+	}
+
+	return i;
+#else
+	const uint8_t *const zero = z_cobs_find_zero(input, length);
+	const size_t copy_length = zero ? (size_t)(zero - input) : length;
+
+	memmove(output, input, copy_length);
+	return copy_length;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_SCAN_H_ */
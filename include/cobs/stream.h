@@ -4,12 +4,28 @@
 #define COBS_STREAM_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __ZEPHYR__
 #include <version.h>
 
 #ifdef CONFIG_ZEPHYR_NRF_MODULE
 #include <ncs_version.h>
 #endif
 
+#if KERNEL_VERSION_NUMBER < 0x30100
+#include <sys/util.h>
+#include <toolchain.h>
+#else
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+#endif
+#else
+#include <cobs/host.h>
+#endif /* __ZEPHYR__ */
+
+#ifdef CONFIG_COBS_NET_BUF
 #if KERNEL_VERSION_NUMBER < 0x30100
 #include <net/buf.h>
 #elif NCS_VERSION_NUMBER < 0x20800 && KERNEL_VERSION_NUMBER < 0x40000
@@ -17,9 +33,82 @@
 #else
 #include <zephyr/net_buf.h>
 #endif
+#endif /* CONFIG_COBS_NET_BUF */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct cobs_encode_source;
+struct net_buf;
+
+/**
+ * Operations of an input source for `struct cobs_encode`.
+ *
+ * The encoder only calls these once per block or contiguous span of data,
+ * never per byte.
+ */
+struct cobs_encode_source_api {
+	/**
+	 * Get the contiguous data at the current position.
+	 *
+	 * Writes a pointer to the data to `data` and returns the number of
+	 * bytes which are available there. Returns 0 only if there's no data
+	 * left.
+	 */
+	size_t (*span)(struct cobs_encode_source *source, const uint8_t **data);
+
+	/**
+	 * Consume `length` bytes of the span returned by the last call to
+	 * `span`.
+	 */
+	void (*advance)(struct cobs_encode_source *source, size_t length);
+
+	/**
+	 * Find the next zero-byte within the next `max_length` bytes without
+	 * consuming anything. This may have to look beyond the current span.
+	 *
+	 * Returns 0 and writes the offset of the zero-byte to `offset` if
+	 * there is one. Otherwise, returns -ENOENT and writes the number of
+	 * bytes that were looked at, which is less than `max_length` only if
+	 * the data ends before, to `offset`.
+	 */
+	int (*find_zero)(struct cobs_encode_source *source, size_t max_length, size_t *offset);
+
+	/** Release all resources of the source. May be NULL. */
+	void (*release)(struct cobs_encode_source *source);
+};
+
+/** Input source for `struct cobs_encode`. Embed this in your own source. */
+struct cobs_encode_source {
+	const struct cobs_encode_source_api *api;
+};
 
+/** Source for data within a `net_buf` chain. */
 struct cobs_buf_cursor {
+	struct cobs_encode_source source;
+
+	/** @internal The referenced head of the chain. */
+	struct net_buf *head;
+
+	/** @internal The current fragment, kept alive by `head`. */
 	struct net_buf *buf;
+
+	/** @internal Offset within `buf`. */
+	size_t offset;
+};
+
+/** Source for data within a flat buffer, e.g. memory-mapped flash. */
+struct cobs_mem_source {
+	struct cobs_encode_source source;
+
+	/** @internal The data. */
+	const uint8_t *data;
+
+	/** @internal Size of `data`. */
+	size_t length;
+
+	/** @internal Offset of the next byte within `data`. */
 	size_t offset;
 };
 
@@ -56,71 +145,171 @@ struct cobs_decode {
 	bool pending_zero;
 };
 
-enum cobs_encode_state {
-	/**
-	 * 0x01 will be written.
-	 *
-	 * We're at a place where the 0x01 does not represent data. This is the
-	 * case at the very beginning of the frame or at the code that came
-	 * after a 0xff code.
-	 */
-	COBS_ENCODE_STATE_ZEROS_FIRSTBYTE,
+/** Results of #cobs_decode_isr_step which aren't output bytes. */
+enum cobs_decode_isr_result {
+	/** The byte was consumed, but there's no output. */
+	COBS_DECODE_ISR_NO_OUTPUT = -1,
+	/** The frame is complete. */
+	COBS_DECODE_ISR_FINISHED = -2,
+	/** A zero-byte was received in the middle of a block. */
+	COBS_DECODE_ISR_UNEXPECTED_ZERO = -3,
+	/** The decoder was already finished. */
+	COBS_DECODE_ISR_ERROR = -4,
+};
 
-	/** We still have zeros and have to write an encoded zero now. */
-	COBS_ENCODE_STATE_ZEROS_CODE,
-	/** We still have zeros and have to write non-zero data. */
-	COBS_ENCODE_STATE_ZEROS_DATA,
+/** @internal Mask of the number of data bytes left within the current block. */
+#define Z_COBS_DECODE_ISR_LEFT_MASK 0x00FFU
 
-	/**
-	 * No more zeros and we have to write a code now.
-	 *
-	 * We still need codes due to the 254-byte chunking. So this is gonna
-	 * be 0xFF for all codes except (maybe) the last one.
-	 */
-	COBS_ENCODE_STATE_NOZEROS_CODE,
+/** @internal A zero has to be written at the next code. */
+#define Z_COBS_DECODE_ISR_PENDING_ZERO 0x0100U
+
+/** @internal The frame ended and the decoder has to be reset. */
+#define Z_COBS_DECODE_ISR_DONE 0x0200U
 
-	/** No more zeroes and we have to write data from the current block. */
-	COBS_ENCODE_STATE_NOZEROS_DATA,
+/**
+ * State for the single-byte decoder made for ISRs.
+ *
+ * All of it is packed into one integer. A zero-initialized state is a valid
+ * init-state.
+ */
+struct cobs_decode_isr {
+	/** @internal Combination of the Z_COBS_DECODE_ISR_ values. */
+	uint16_t state;
+};
+
+/**
+ * Clock for the timestamps of #cobs_decode_stream_timed, e.g. a free-running
+ * hardware counter. It is read once per call.
+ */
+typedef uint32_t (*cobs_decode_clock_t)(void);
+
+/** When a frame was received, in ticks of the clock of the decoder. */
+struct cobs_decode_timestamps {
+	/** Time of the call which received the first byte of the frame. */
+	uint32_t first_byte;
+	/** Time of the call which received the zero-byte ending the frame. */
+	uint32_t delimiter;
+};
+
+/**
+ * State for the streaming decoder which records when frames were received.
+ *
+ * This is #cobs_decode with a clock which is read once per call of
+ * #cobs_decode_stream_timed, so the timestamps have the granularity of the
+ * chunks passed to it.
+ */
+struct cobs_decode_timed {
+	struct cobs_decode decode;
+
+	/** @internal The clock, NULL for k_cycle_get_32. */
+	cobs_decode_clock_t clock;
+
+	/** @internal Time of the first byte of the current frame. */
+	uint32_t first_byte;
+
+	/** @internal If true, the first byte of the current frame was received. */
+	bool started;
+};
+
+enum cobs_encode_state {
+	/** The code of the next block has to be written. */
+	COBS_ENCODE_STATE_CODE = 0,
+	/** Data of the current block has to be written. */
+	COBS_ENCODE_STATE_DATA,
 	/** The final zero at the end of the frame. */
 	COBS_ENCODE_STATE_FINAL_ZERO,
 	/** All data was written and the encode must not be called again. */
 	COBS_ENCODE_STATE_FINISHED,
 };
 
-struct cobs_encode_zeros {
-	/** @internal Position of the next zero-byte within `buf` within `struct cobs_encode`. */
-	size_t next_zero;
+struct cobs_encode {
+	/** @internal Storage for the source used by #cobs_encode_stream_init. */
+	struct cobs_buf_cursor cursor;
+
+	/** @internal The source of the data to encode. */
+	struct cobs_encode_source *source;
 
-	/**
-	 * @internal Number of non-zero data left to write.
-	 *
-	 * This is used by the state COBS_ENCODE_STATE_ZEROS_DATA.
-	 */
-	size_t data_left;
+	enum cobs_encode_state state;
 
-	/** @internal The state that comes after COBS_ENCODE_STATE_ZEROS_DATA. */
-	enum cobs_encode_state post_data_state;
+	/** @internal Code of the current block. */
+	uint8_t code;
+
+	/** @internal Number of data bytes left to write in the current block. */
+	uint8_t data_left;
+};
+
+enum cobs_encode_flat_state {
+	COBS_ENCODE_FLAT_STATE_CODE = 0,
+	COBS_ENCODE_FLAT_STATE_DATA,
+	COBS_ENCODE_FLAT_STATE_FINAL_ZERO,
+	COBS_ENCODE_FLAT_STATE_FINISHED,
 };
 
-struct cobs_encode_nozeros {
-	size_t total_length;
+/**
+ * State for the streaming encoder for flat buffers.
+ *
+ * Unlike `struct cobs_encode`, this doesn't need a source and only has a few
+ * bytes of state.
+ */
+struct cobs_encode_flat {
+	/** @internal The data to encode. */
+	const uint8_t *input;
+
+	/** @internal Size of `input`. */
+	size_t length;
+
+	/** @internal Offset of the next byte to read from `input`. */
+	size_t read_index;
+
+	/** @internal Code of the current block. */
+	uint8_t code;
+
+	/** @internal Number of data bytes left to write in the current block. */
+	uint8_t data_left;
+
+	/** @internal The current `enum cobs_encode_flat_state`. */
+	uint8_t state;
+};
+
+enum cobs_encode_append_state {
+	/** Data can be appended. */
+	COBS_ENCODE_APPEND_STATE_DATA = 0,
+	/** The final block and zero-byte have to be written. */
+	COBS_ENCODE_APPEND_STATE_FINAL_ZERO,
+	/** All data was written. */
+	COBS_ENCODE_APPEND_STATE_FINISHED,
+};
+
+/**
+ * State for the streaming encoder which takes its data in chunks.
+ *
+ * A block can only be written once its end is known, so up to 254 bytes of
+ * data are buffered within this state. Blocks which are fully within an input
+ * chunk are written directly if the output has enough space.
+ *
+ * A zero-initialized state is a valid init-state.
+ */
+struct cobs_encode_append {
+	/** @internal Data of the current block. */
+	uint8_t block[254];
+
+	/** @internal Number of bytes within `block`. */
+	uint8_t block_length;
 
 	/**
-	 * @internal How much data to write before the next code.
-	 *
-	 * Used by the state COBS_ENCODE_STATE_ZEROS_DATA.
+	 * @internal Code of the current block if it is complete and has to be
+	 * written, otherwise 0.
 	 */
-	size_t data_left;
-};
+	uint8_t code;
 
-struct cobs_encode {
-	struct cobs_buf_cursor cursor;
-	enum cobs_encode_state state;
+	/** @internal Number of bytes of the complete block written so far. */
+	uint8_t written;
+
+	/** @internal If true, the last complete block was a 0xFF-block. */
+	bool last_full;
 
-	union {
-		struct cobs_encode_zeros zeros;
-		struct cobs_encode_nozeros nozeros;
-	} u;
+	/** @internal The current `enum cobs_encode_append_state`. */
+	uint8_t state;
 };
 
 /**
@@ -168,6 +357,94 @@ static inline void cobs_decode_reset(struct cobs_decode *decode)
 	};
 }
 
+/**
+ * Initialize the decoder which records timestamps.
+ *
+ * `clock` is read once per call of #cobs_decode_stream_timed. If it's NULL,
+ * `k_cycle_get_32` is used, which is only available with Zephyr.
+ */
+static inline void cobs_decode_timed_init(struct cobs_decode_timed *decode,
+					  cobs_decode_clock_t clock)
+{
+	*decode = (struct cobs_decode_timed){
+		.clock = clock,
+	};
+	cobs_decode_reset(&decode->decode);
+}
+
+/**
+ * Pass multiple bytes to the decoder which records timestamps.
+ *
+ * This works like #cobs_decode_stream. When COBS_DECODE_RESULT_FINISHED is
+ * returned, the times the first and the last byte of the frame were passed to
+ * the decoder are written to `timestamps`.
+ */
+enum cobs_decode_result cobs_decode_stream_timed(struct cobs_decode_timed *decode,
+						 const uint8_t *input, size_t input_size,
+						 uint8_t *output, size_t output_size, size_t *num_read,
+						 size_t *num_written,
+						 struct cobs_decode_timestamps *timestamps);
+
+/** Reset the decoder which records timestamps after a frame. */
+static inline void cobs_decode_timed_reset(struct cobs_decode_timed *decode)
+{
+	cobs_decode_reset(&decode->decode);
+	decode->started = false;
+}
+
+/** Reset the single-byte decoder, e.g. after a frame was finished. */
+static inline void cobs_decode_isr_reset(struct cobs_decode_isr *decode)
+{
+	decode->state = 0;
+}
+
+/**
+ * Pass a single byte to the decoder.
+ *
+ * This decodes the same data as #cobs_decode_stream_single, but is made to be
+ * inlined into an ISR: A data byte takes two well-predictable branches and
+ * nothing but the state is written to memory.
+ *
+ * Returns the decoded byte (0x00 - 0xFF) if there is one, or one of
+ * `enum cobs_decode_isr_result`. After anything but a decoded byte or
+ * COBS_DECODE_ISR_NO_OUTPUT, the decoder has to be reset.
+ */
+static ALWAYS_INLINE int cobs_decode_isr_step(struct cobs_decode_isr *decode, uint8_t input_byte)
+{
+	const uint16_t state = decode->state;
+
+	if (likely(input_byte != 0)) {
+		if (likely(state & Z_COBS_DECODE_ISR_LEFT_MASK)) {
+			decode->state = state - 1;
+			return input_byte;
+		}
+
+		if (unlikely(state & Z_COBS_DECODE_ISR_DONE)) {
+			return COBS_DECODE_ISR_ERROR;
+		}
+
+		/* A code. Only blocks shorter than 254 bytes end with a zero,
+		 * which is written when the next code is received.
+		 */
+		decode->state = (uint16_t)(input_byte - 1) |
+				(input_byte != 0xFF ? Z_COBS_DECODE_ISR_PENDING_ZERO : 0);
+		return (state & Z_COBS_DECODE_ISR_PENDING_ZERO) ? 0x00 : COBS_DECODE_ISR_NO_OUTPUT;
+	}
+
+	decode->state = Z_COBS_DECODE_ISR_DONE;
+
+	if (state & Z_COBS_DECODE_ISR_DONE) {
+		return COBS_DECODE_ISR_ERROR;
+	}
+
+	if (state & Z_COBS_DECODE_ISR_LEFT_MASK) {
+		return COBS_DECODE_ISR_UNEXPECTED_ZERO;
+	}
+
+	return COBS_DECODE_ISR_FINISHED;
+}
+
+#ifdef CONFIG_COBS_NET_BUF
 /**
  * Initialize stream.
  *
@@ -178,6 +455,26 @@ static inline void cobs_decode_reset(struct cobs_decode *decode)
  */
 void cobs_encode_stream_init(struct cobs_encode *encode, struct net_buf *buf);
 
+/**
+ * Initialize a source for the data of the chain `buf`.
+ *
+ * Creates a new reference to `buf`, which is released by the `release`
+ * operation of the source.
+ */
+void cobs_buf_cursor_init(struct cobs_buf_cursor *cursor, struct net_buf *buf);
+#endif /* CONFIG_COBS_NET_BUF */
+
+/**
+ * Initialize stream with a custom source.
+ *
+ * `source` has to stay valid until `cobs_encode_stream_free` was called,
+ * which releases it.
+ */
+void cobs_encode_stream_init_source(struct cobs_encode *encode, struct cobs_encode_source *source);
+
+/** Initialize a source for `length` bytes of `data`. */
+void cobs_mem_source_init(struct cobs_mem_source *source, const void *data, size_t length);
+
 /**
  * Abort stream.
  *
@@ -201,4 +498,138 @@ void cobs_encode_stream_free(struct cobs_encode *encode);
  */
 size_t cobs_encode_stream(struct cobs_encode *encode, uint8_t *output, size_t output_length);
 
+#ifdef CONFIG_COBS_NET_BUF
+/**
+ * Encode `length` bytes of `input` into the tailroom of `output`.
+ *
+ * This works like #cobs_encode, so the output doesn't include the final
+ * zero-byte. The encoded data is written directly behind the data that's
+ * already in `output` and is added to it. The headroom and at least
+ * `reserved_tailroom` bytes of tailroom are kept free, so headers and
+ * trailers can be added with `net_buf_push` and `net_buf_add` afterwards
+ * without moving the encoded data.
+ *
+ * Returns 0 on success or -ENOMEM if the tailroom of `output` is smaller than
+ * `COBS_MAX_ENCODED_SIZE(length) + reserved_tailroom`.
+ */
+int cobs_encode_buf(struct net_buf *output, const uint8_t *input, size_t length,
+		    size_t reserved_tailroom);
+
+/**
+ * Encode more data into the tailroom of `output`.
+ *
+ * This works like #cobs_encode_stream, but writes directly behind the data
+ * that's already in `output` and adds the written bytes to it. The headroom
+ * and at least `reserved_tailroom` bytes of tailroom are kept free, so headers
+ * and trailers can be added with `net_buf_push` and `net_buf_add` afterwards
+ * without moving the encoded data.
+ *
+ * Returns the number of bytes added to `output`, which is `0` when there's no
+ * more data left to encode or no more space within `output`.
+ */
+size_t cobs_encode_stream_buf(struct cobs_encode *encode, struct net_buf *output,
+			      size_t reserved_tailroom);
+
+/** Size of the data of buffers within a pool for #cobs_encode_zc. */
+#define COBS_ENCODE_ZC_CODE_SIZE 8
+
+/**
+ * Define a pool of `_count` buffers for #cobs_encode_zc.
+ *
+ * Every block of the encoded data needs one buffer for its code and one buffer
+ * per input fragment that its data is spread over. Codes of consecutive empty
+ * blocks share buffers.
+ */
+#define COBS_ENCODE_ZC_POOL_DEFINE(_name, _count)                                                  \
+	NET_BUF_POOL_FIXED_DEFINE(_name, _count, COBS_ENCODE_ZC_CODE_SIZE,                         \
+				  sizeof(struct net_buf *), cobs_encode_zc_destroy)
+
+/** @internal Destroy callback of pools defined with #COBS_ENCODE_ZC_POOL_DEFINE. */
+void cobs_encode_zc_destroy(struct net_buf *buf);
+
+/**
+ * Encode the data of `input` without copying it.
+ *
+ * This produces the same data as #cobs_encode_stream, including the final
+ * zero-byte, as a new chain of buffers allocated from `pool`, which has to be
+ * defined with #COBS_ENCODE_ZC_POOL_DEFINE. Buffers holding the codes alternate
+ * with buffers that point into the data of `input`, so the chain can be passed
+ * to transports that gather the fragments with DMA.
+ *
+ * The data of `input` is still scanned for zero-bytes, but nothing is copied
+ * and the number of allocations only depends on the number of blocks and
+ * fragments. The output holds references to `input`, so `input` must not be
+ * modified until the output was freed. The caller keeps its own reference.
+ *
+ * Returns 0 and writes the chain to `output` on success. Returns -ENOMEM if
+ * not all buffers could be allocated within `timeout`, in which case nothing
+ * is written to `output`.
+ */
+int cobs_encode_zc(struct net_buf *input, struct net_buf_pool *pool, k_timeout_t timeout,
+		   struct net_buf **output);
+#endif /* CONFIG_COBS_NET_BUF */
+
+/**
+ * Initialize streaming encoder for a flat buffer.
+ *
+ * `input` has to stay valid and unmodified until the encoder is finished.
+ * There's nothing to free afterwards.
+ */
+static inline void cobs_encode_flat_init(struct cobs_encode_flat *encode, const void *input,
+					 size_t length)
+{
+	*encode = (struct cobs_encode_flat){
+		.input = (const uint8_t *)input,
+		.length = length,
+		.state = COBS_ENCODE_FLAT_STATE_CODE,
+	};
+}
+
+/**
+ * Encode more data into `output`.
+ *
+ * This works like #cobs_encode_stream, so the output includes the final
+ * zero-byte and `0` is returned when there's no more data left to encode.
+ * `output_length` may be of any size. Data is copied in blocks and the work of
+ * each call is proportional to the number of bytes written, plus a scan of up
+ * to 254 bytes for each code.
+ */
+size_t cobs_encode_flat(struct cobs_encode_flat *encode, uint8_t *output, size_t output_length);
+
+/** Initialize encoder for data which is appended in chunks. */
+static inline void cobs_encode_append_init(struct cobs_encode_append *encode)
+{
+	encode->block_length = 0;
+	encode->code = 0;
+	encode->written = 0;
+	encode->last_full = false;
+	encode->state = COBS_ENCODE_APPEND_STATE_DATA;
+}
+
+/**
+ * Pass more data of the frame to the encoder.
+ *
+ * Every block whose end is known is written to `output`. This function will
+ * stop if all input bytes were consumed or if there's no space left within
+ * `output`, so you may have to call it again with the rest of the data.
+ *
+ * Input which is passed after #cobs_encode_append_finish was called is
+ * ignored.
+ */
+void cobs_encode_append(struct cobs_encode_append *encode, const uint8_t *input, size_t input_size,
+			uint8_t *output, size_t output_size, size_t *num_read, size_t *num_written);
+
+/**
+ * Finish the frame.
+ *
+ * Writes the remaining buffered data and the final zero-byte. Like
+ * #cobs_encode_stream, this has to be called until it returns `0`.
+ */
+size_t cobs_encode_append_finish(struct cobs_encode_append *encode, uint8_t *output,
+				 size_t output_size);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* COBS_STREAM_H_ */
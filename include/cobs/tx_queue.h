@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: MIT */
+
+#ifndef COBS_TX_QUEUE_H_
+#define COBS_TX_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
+#include <cobs/stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Queue of messages which are encoded as frames by a single consumer, e.g.
+ * the TX interrupt of a UART.
+ *
+ * Any number of threads and ISRs can submit messages without locks: a
+ * submission is a compare-and-swap on the head of a list, which is only
+ * repeated if another message was submitted at the same time. The consumer
+ * takes the whole list at once whenever it runs out of messages, so producers
+ * never wait for the consumer.
+ *
+ * Messages are encoded in the order they were submitted.
+ *
+ * The consumer is either running or stopped, and starts out stopped. It stops
+ * with #cobs_tx_queue_stop, which only succeeds if no message is queued, and
+ * the first message submitted after that tells its producer to start the
+ * consumer again. So exactly one producer wakes up the consumer, and no
+ * message is left in the queue without one.
+ */
+struct cobs_tx_queue {
+	/**
+	 * @internal Submitted messages, newest first, linked by their `node`,
+	 * or a marker while the consumer is stopped.
+	 */
+	atomic_ptr_t submitted;
+	/** @internal Messages taken by the consumer, oldest first. */
+	sys_snode_t *pending;
+	/** @internal Encoder of the current message, finished if there's none. */
+	struct cobs_encode encode;
+};
+
+/** Initialize the queue, with the consumer stopped. */
+void cobs_tx_queue_init(struct cobs_tx_queue *queue);
+
+/**
+ * Submit a message.
+ *
+ * The queue takes over the reference to `buf`, which must not be within
+ * another list or queue, and releases it once its frame was encoded. This
+ * never blocks, so it can be called from any thread or ISR.
+ *
+ * Returns true if the consumer was stopped, in which case the caller has to
+ * start it, e.g. by enabling the TX interrupt.
+ */
+bool cobs_tx_queue_submit(struct cobs_tx_queue *queue, struct net_buf *buf);
+
+/**
+ * Encode the queued messages into `output`.
+ *
+ * Frames are continued across calls, so `output` can be of any size, like the
+ * FIFO of a UART. Must only be called from the consumer.
+ *
+ * Returns the number of bytes written, which is 0 once the queue is empty.
+ * The consumer is still running then, see #cobs_tx_queue_stop.
+ */
+size_t cobs_tx_queue_encode(struct cobs_tx_queue *queue, uint8_t *output, size_t output_size);
+
+/**
+ * Stop the consumer after #cobs_tx_queue_encode returned 0.
+ *
+ * The consumer has to make sure it isn't called anymore before, e.g. by
+ * disabling the TX interrupt, since a producer may start it again as soon as
+ * this succeeded. Must only be called from the consumer.
+ *
+ * Returns true if the consumer is stopped. Returns false if a message was
+ * submitted in the meantime, in which case the consumer keeps running and has
+ * to undo what it did to stop, e.g. enable the TX interrupt again.
+ */
+bool cobs_tx_queue_stop(struct cobs_tx_queue *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COBS_TX_QUEUE_H_ */
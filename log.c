@@ -0,0 +1,427 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <cobs.h>
+#include <cobs/log.h>
+
+/* "COBL" */
+#define COBS_LOG_MAGIC 0x4C424F43
+
+/* Magic and number of the first record of the block. */
+#define HEADER_LENGTH 8
+
+/* The encoded header and its delimiter. */
+#define HEADER_ENCODED_LENGTH (COBS_MAX_ENCODED_SIZE(HEADER_LENGTH) + 1)
+
+static size_t header_size(const struct cobs_log *log)
+{
+	return ROUND_UP(HEADER_ENCODED_LENGTH, log->align);
+}
+
+static off_t block_offset(const struct cobs_log *log, size_t block)
+{
+	return (off_t)(block * log->block_size);
+}
+
+/* Pads `length` bytes of the buffer with zero-bytes to the write block size
+ * and appends them to the current block. On failure, the rest of the block is
+ * abandoned since it's unknown what was written.
+ */
+static int write_padded(struct cobs_log *log, size_t length)
+{
+	const size_t padded_length = ROUND_UP(length, log->align);
+
+	memset(&log->buffer[length], 0, padded_length - length);
+
+	const int ret = flash_area_write(log->fa, block_offset(log, log->block) + log->write_offset,
+					 log->buffer, padded_length);
+	if (ret) {
+		log->write_offset = log->block_size;
+		return ret;
+	}
+
+	log->write_offset += padded_length;
+	return 0;
+}
+
+/* Returns -ENOENT if the block isn't in use yet and -EINVAL if writing its
+ * header was interrupted.
+ */
+static int read_header(const struct cobs_log *log, size_t block, uint32_t *first_record)
+{
+	uint8_t encoded[HEADER_ENCODED_LENGTH];
+	uint8_t header[HEADER_ENCODED_LENGTH];
+	size_t header_length;
+
+	int ret = flash_area_read(log->fa, block_offset(log, block), encoded, sizeof(encoded));
+	if (ret) {
+		return ret;
+	}
+
+	if (encoded[0] == flash_area_erased_val(log->fa)) {
+		return -ENOENT;
+	}
+
+	if (encoded[sizeof(encoded) - 1] != 0 ||
+	    cobs_decode(encoded, sizeof(encoded) - 1, header, &header_length) ||
+	    header_length != HEADER_LENGTH || sys_get_le32(header) != COBS_LOG_MAGIC) {
+		return -EINVAL;
+	}
+
+	*first_record = sys_get_le32(&header[4]);
+	return 0;
+}
+
+/*
+ * Walks over the records of the block within the buffer, which are all
+ * non-empty frames terminated by a zero-byte. Consecutive zero-bytes are
+ * padding.
+ *
+ * If the block contains record `index`, counting from the first one of the
+ * block, `frame` and `frame_length` are set to its frame. Returns the number
+ * of records before that or within the block.
+ */
+static uint32_t find_record(const struct cobs_log *log, uint32_t index, const uint8_t **frame,
+			    size_t *frame_length)
+{
+	const uint8_t *data = &log->buffer[header_size(log)];
+	const uint8_t *const end = &log->buffer[log->block_size];
+	uint32_t num_records = 0;
+
+	*frame = NULL;
+
+	while (data < end) {
+		const uint8_t *const zero = memchr(data, 0, end - data);
+		if (!zero) {
+			break;
+		}
+
+		if (zero != data) {
+			if (num_records == index) {
+				*frame = data;
+				*frame_length = zero - data;
+				break;
+			}
+
+			num_records++;
+		}
+
+		data = zero + 1;
+	}
+
+	return num_records;
+}
+
+/* Counts the records up to the end of `block`. Blocks whose header is corrupt
+ * don't hold any records.
+ */
+static int count_records(struct cobs_log *log, size_t block, uint32_t *num_records)
+{
+	const uint8_t *frame;
+	size_t frame_length;
+	uint32_t first_record;
+	int ret;
+
+	for (;;) {
+		ret = read_header(log, block, &first_record);
+		if (ret == 0) {
+			break;
+		}
+
+		if (ret != -EINVAL) {
+			return ret;
+		}
+
+		if (block == 0) {
+			*num_records = 0;
+			return 0;
+		}
+
+		block--;
+	}
+
+	ret = flash_area_read(log->fa, block_offset(log, block), log->buffer, log->block_size);
+	if (ret) {
+		return ret;
+	}
+
+	*num_records = first_record + find_record(log, UINT32_MAX, &frame, &frame_length);
+	return 0;
+}
+
+/* Number of blocks which are in use, which are always the first ones. */
+static int count_blocks(struct cobs_log *log, size_t *num_blocks)
+{
+	size_t low = 0;
+	size_t high = log->num_blocks;
+
+	while (low < high) {
+		const size_t mid = low + (high - low) / 2;
+		uint32_t first_record;
+
+		const int ret = read_header(log, mid, &first_record);
+		if (ret == -ENOENT) {
+			high = mid;
+		} else if (ret == 0 || ret == -EINVAL) {
+			low = mid + 1;
+		} else {
+			return ret;
+		}
+	}
+
+	*num_blocks = low;
+	return 0;
+}
+
+/* Finds the end of the data within the last block. */
+static int recover(struct cobs_log *log)
+{
+	const uint8_t erased = flash_area_erased_val(log->fa);
+	uint32_t first_record;
+
+	int ret = read_header(log, log->block, &first_record);
+	if (ret == -EINVAL) {
+		/* Writing the header was interrupted, so the block has no
+		 * records and is abandoned.
+		 */
+		log->write_offset = log->block_size;
+		return count_records(log, log->block, &log->num_records);
+	} else if (ret) {
+		return ret;
+	}
+
+	ret = flash_area_read(log->fa, block_offset(log, log->block), log->buffer,
+			      log->block_size);
+	if (ret) {
+		return ret;
+	}
+
+	size_t end = log->block_size;
+
+	while (log->buffer[end - 1] == erased) {
+		end--;
+	}
+
+	/* Every write ends with zero-bytes up to the write block size. If it
+	 * doesn't, a write was interrupted. Its frame has no delimiter, so it
+	 * isn't counted, and the partially written part can't be written
+	 * again, so the rest of the block is abandoned.
+	 */
+	if (end % log->align == 0 && log->buffer[end - 1] == 0) {
+		log->write_offset = end;
+	} else {
+		log->write_offset = log->block_size;
+	}
+
+	const uint8_t *frame;
+	size_t frame_length;
+
+	log->num_records = first_record + find_record(log, UINT32_MAX, &frame, &frame_length);
+	return 0;
+}
+
+int cobs_log_init(struct cobs_log *log, const struct flash_area *fa, uint8_t *buffer,
+		  size_t buffer_size)
+{
+	const size_t align = flash_area_align(fa);
+
+	/* Nothing could be told apart from the delimiters. */
+	if (flash_area_erased_val(fa) == 0) {
+		return -ENOTSUP;
+	}
+
+	if (align == 0 || buffer_size % align != 0 ||
+	    buffer_size <= ROUND_UP(HEADER_ENCODED_LENGTH, align) || fa->fa_size < buffer_size) {
+		return -EINVAL;
+	}
+
+	*log = (struct cobs_log){
+		.fa = fa,
+		.buffer = buffer,
+		.block_size = buffer_size,
+		.num_blocks = fa->fa_size / buffer_size,
+		.align = align,
+		.block = 0,
+		.write_offset = 0,
+		.num_records = 0,
+	};
+
+	size_t num_blocks;
+
+	int ret = count_blocks(log, &num_blocks);
+	if (ret) {
+		return ret;
+	}
+
+	if (num_blocks == 0) {
+		return 0;
+	}
+
+	log->block = num_blocks - 1;
+	return recover(log);
+}
+
+int cobs_log_append(struct cobs_log *log, const void *data, size_t length)
+{
+	const size_t max_size = ROUND_UP(COBS_MAX_ENCODED_SIZE(length) + 1, log->align);
+	int ret;
+
+	if (max_size > log->block_size - header_size(log)) {
+		return -EMSGSIZE;
+	}
+
+	if (log->write_offset == 0 || log->write_offset + max_size > log->block_size) {
+		if (log->write_offset != 0) {
+			if (log->block + 1 == log->num_blocks) {
+				return -ENOSPC;
+			}
+
+			log->block++;
+			log->write_offset = 0;
+		}
+
+		uint8_t header[HEADER_LENGTH];
+
+		sys_put_le32(COBS_LOG_MAGIC, header);
+		sys_put_le32(log->num_records, &header[4]);
+
+		const size_t encoded_length = cobs_encode(header, sizeof(header), log->buffer);
+		log->buffer[encoded_length] = 0x00;
+
+		ret = write_padded(log, encoded_length + 1);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	const size_t encoded_length = cobs_encode(data, length, log->buffer);
+	log->buffer[encoded_length] = 0x00;
+
+	ret = write_padded(log, encoded_length + 1);
+	if (ret) {
+		return ret;
+	}
+
+	log->num_records++;
+	return 0;
+}
+
+/* Finds the block holding `record` with a binary search over the headers.
+ * Blocks with a corrupt header are skipped.
+ */
+static int find_block(const struct cobs_log *log, uint32_t record, size_t *block,
+		      uint32_t *first_record)
+{
+	size_t low = 0;
+	size_t high = log->block + 1;
+	bool found = false;
+
+	while (low < high) {
+		const size_t mid = low + (high - low) / 2;
+		size_t candidate = mid;
+		uint32_t candidate_first;
+		int ret;
+
+		for (;;) {
+			ret = read_header(log, candidate, &candidate_first);
+			if (ret != -EINVAL || candidate == low) {
+				break;
+			}
+
+			candidate--;
+		}
+
+		if (ret == -EINVAL) {
+			low = mid + 1;
+		} else if (ret) {
+			return ret;
+		} else if (candidate_first <= record) {
+			*block = candidate;
+			*first_record = candidate_first;
+			found = true;
+			low = mid + 1;
+		} else {
+			high = candidate;
+		}
+	}
+
+	return found ? 0 : -EINVAL;
+}
+
+int cobs_log_read(struct cobs_log *log, uint32_t record, void *data, size_t size,
+		  size_t *length)
+{
+	size_t block;
+	uint32_t first_record;
+	const uint8_t *frame;
+	size_t frame_length;
+
+	if (record >= log->num_records) {
+		return -ENOENT;
+	}
+
+	int ret = find_block(log, record, &block, &first_record);
+	if (ret) {
+		return ret;
+	}
+
+	ret = flash_area_read(log->fa, block_offset(log, block), log->buffer, log->block_size);
+	if (ret) {
+		return ret;
+	}
+
+	find_record(log, record - first_record, &frame, &frame_length);
+	if (!frame) {
+		return -EINVAL;
+	}
+
+	/* Copy the runs of decoded data while they fit, but keep counting to
+	 * report the length of the record anyway.
+	 */
+	struct cobs_decode_runs runs;
+	const uint8_t *run;
+	size_t run_length;
+	bool followed_by_zero;
+	uint8_t *const output = data;
+	size_t num_written = 0;
+
+	cobs_decode_runs_init(&runs, frame, frame_length);
+
+	while ((ret = cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero)) > 0) {
+		const size_t run_size = run_length + followed_by_zero;
+
+		if (num_written + run_size <= size) {
+			memcpy(&output[num_written], run, run_length);
+			if (followed_by_zero) {
+				output[num_written + run_length] = 0x00;
+			}
+		}
+
+		num_written += run_size;
+	}
+
+	if (ret) {
+		return ret;
+	}
+
+	*length = num_written;
+	return num_written <= size ? 0 : -ENOMEM;
+}
+
+int cobs_log_clear(struct cobs_log *log)
+{
+	const int ret = flash_area_erase(log->fa, 0, log->fa->fa_size);
+
+	log->block = 0;
+	log->write_offset = ret ? log->block_size : 0;
+	log->num_records = 0;
+
+	return ret;
+}
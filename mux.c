@@ -0,0 +1,378 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+#include <cobs.h>
+#include <cobs/mux.h>
+
+#define INDEX_MASK 0x0F
+
+static size_t cobs_mux_source_span(struct cobs_encode_source *source, const uint8_t **data)
+{
+	struct cobs_mux_source *const mux_source =
+		CONTAINER_OF(source, struct cobs_mux_source, source);
+
+	if (mux_source->header_offset < Z_COBS_MUX_HEADER_SIZE) {
+		*data = &mux_source->header[mux_source->header_offset];
+		return Z_COBS_MUX_HEADER_SIZE - mux_source->header_offset;
+	}
+
+	if (mux_source->left == 0) {
+		return 0;
+	}
+
+	struct cobs_encode_source *const message = &mux_source->channel->cursor.source;
+
+	return MIN(message->api->span(message, data), mux_source->left);
+}
+
+static void cobs_mux_source_advance(struct cobs_encode_source *source, size_t length)
+{
+	struct cobs_mux_source *const mux_source =
+		CONTAINER_OF(source, struct cobs_mux_source, source);
+
+	if (mux_source->header_offset < Z_COBS_MUX_HEADER_SIZE) {
+		__ASSERT_NO_MSG(mux_source->header_offset + length <= Z_COBS_MUX_HEADER_SIZE);
+		mux_source->header_offset += length;
+		return;
+	}
+
+	struct cobs_mux_channel *const channel = mux_source->channel;
+
+	__ASSERT_NO_MSG(length <= mux_source->left);
+	channel->cursor.source.api->advance(&channel->cursor.source, length);
+	mux_source->left -= length;
+	channel->left -= length;
+}
+
+static int cobs_mux_source_find_zero(struct cobs_encode_source *source, size_t max_length,
+				     size_t *offset)
+{
+	struct cobs_mux_source *const mux_source =
+		CONTAINER_OF(source, struct cobs_mux_source, source);
+	size_t num_processed = 0;
+
+	if (mux_source->header_offset < Z_COBS_MUX_HEADER_SIZE) {
+		const uint8_t *const header = &mux_source->header[mux_source->header_offset];
+		const size_t length =
+			MIN(Z_COBS_MUX_HEADER_SIZE - mux_source->header_offset, max_length);
+
+		const uint8_t *const zero = memchr(header, 0, length);
+		if (zero) {
+			*offset = (size_t)(zero - header);
+			return 0;
+		}
+
+		num_processed = length;
+	}
+
+	if (num_processed < max_length && mux_source->left > 0) {
+		struct cobs_encode_source *const message = &mux_source->channel->cursor.source;
+		size_t message_offset;
+
+		const int ret = message->api->find_zero(
+			message, MIN(max_length - num_processed, mux_source->left), &message_offset);
+
+		*offset = num_processed + message_offset;
+		return ret;
+	}
+
+	*offset = num_processed;
+	return -ENOENT;
+}
+
+static const struct cobs_encode_source_api cobs_mux_source_api = {
+	.span = cobs_mux_source_span,
+	.advance = cobs_mux_source_advance,
+	.find_zero = cobs_mux_source_find_zero,
+};
+
+int cobs_mux_init(struct cobs_mux *mux, struct cobs_mux_channel *channels, size_t num_channels,
+		  size_t fragment_size)
+{
+	if (num_channels == 0 || num_channels > UINT8_MAX + 1 || fragment_size == 0) {
+		return -EINVAL;
+	}
+
+	*mux = (struct cobs_mux){
+		.channels = channels,
+		.num_channels = num_channels,
+		.fragment_size = fragment_size,
+		.encode.state = COBS_ENCODE_STATE_FINISHED,
+	};
+
+	for (size_t i = 0; i < num_channels; i++) {
+		struct cobs_mux_channel *const channel = &channels[i];
+
+		k_fifo_init(&channel->fifo);
+		channel->cursor = (struct cobs_buf_cursor){
+			.head = NULL,
+		};
+		channel->left = 0;
+		channel->index = 0;
+	}
+
+	return 0;
+}
+
+int cobs_mux_send(struct cobs_mux *mux, uint8_t channel, struct net_buf *buf)
+{
+	if (channel >= mux->num_channels) {
+		return -EINVAL;
+	}
+
+	k_fifo_put(&mux->channels[channel].fifo, buf);
+	return 0;
+}
+
+/* Starts the next sub-frame of the channel with the highest priority which
+ * has data. Returns false if there's none.
+ */
+static bool start_sub_frame(struct cobs_mux *mux)
+{
+	for (size_t i = 0; i < mux->num_channels; i++) {
+		struct cobs_mux_channel *const channel = &mux->channels[i];
+
+		if (!channel->cursor.head) {
+			struct net_buf *const buf = k_fifo_get(&channel->fifo, K_NO_WAIT);
+			if (!buf) {
+				continue;
+			}
+
+			cobs_buf_cursor_init(&channel->cursor, buf);
+			channel->left = net_buf_frags_len(buf);
+			channel->index = 0;
+			net_buf_unref(buf);
+		}
+
+		const size_t length = MIN(channel->left, mux->fragment_size);
+		uint8_t flags = (channel->index & INDEX_MASK) << Z_COBS_MUX_INDEX_SHIFT;
+
+		if (channel->index == 0) {
+			flags |= Z_COBS_MUX_FIRST;
+		}
+
+		if (length == channel->left) {
+			flags |= Z_COBS_MUX_LAST;
+		}
+
+		mux->source = (struct cobs_mux_source){
+			.source.api = &cobs_mux_source_api,
+			.header = {i, flags},
+			.header_offset = 0,
+			.channel = channel,
+			.left = length,
+		};
+		channel->index++;
+
+		cobs_encode_stream_init_source(&mux->encode, &mux->source.source);
+		return true;
+	}
+
+	return false;
+}
+
+size_t cobs_mux_encode(struct cobs_mux *mux, uint8_t *output, size_t output_size)
+{
+	size_t num_written = 0;
+
+	while (num_written < output_size) {
+		if (mux->encode.state == COBS_ENCODE_STATE_FINISHED && !start_sub_frame(mux)) {
+			break;
+		}
+
+		num_written += cobs_encode_stream(&mux->encode, &output[num_written],
+						  output_size - num_written);
+
+		if (mux->encode.state == COBS_ENCODE_STATE_FINISHED) {
+			struct cobs_mux_channel *const channel = mux->source.channel;
+
+			cobs_encode_stream_free(&mux->encode);
+
+			if (channel->left == 0) {
+				channel->cursor.source.api->release(&channel->cursor.source);
+			}
+		}
+	}
+
+	return num_written;
+}
+
+void cobs_demux_init(struct cobs_demux *demux, struct cobs_demux_channel *channels,
+		     size_t num_channels, cobs_demux_cb_t cb)
+{
+	*demux = (struct cobs_demux){
+		.channels = channels,
+		.num_channels = num_channels,
+		.cb = cb,
+		.header_length = 0,
+		.started = false,
+		.discard = false,
+	};
+	cobs_decode_reset(&demux->decode);
+
+	for (size_t i = 0; i < num_channels; i++) {
+		channels[i].length = 0;
+		channels[i].index = 0;
+		channels[i].active = false;
+	}
+}
+
+static void end_sub_frame(struct cobs_demux *demux)
+{
+	demux->header_length = 0;
+	demux->started = false;
+	demux->discard = false;
+	cobs_decode_reset(&demux->decode);
+}
+
+static void drop_message(struct cobs_demux_channel *channel)
+{
+	channel->length = 0;
+	channel->active = false;
+}
+
+/* Checks the header of the sub-frame against the state of its channel.
+ * Returns the channel, or NULL if the sub-frame has to be skipped.
+ */
+static struct cobs_demux_channel *start_message(struct cobs_demux *demux)
+{
+	const uint8_t flags = demux->header[1];
+	const uint8_t index = flags >> Z_COBS_MUX_INDEX_SHIFT;
+
+	if (demux->header[0] >= demux->num_channels) {
+		return NULL;
+	}
+
+	struct cobs_demux_channel *const channel = &demux->channels[demux->header[0]];
+
+	if (flags & Z_COBS_MUX_FIRST) {
+		channel->length = 0;
+		channel->index = 0;
+		channel->active = true;
+	}
+
+	if (!channel->active || index != (channel->index & INDEX_MASK)) {
+		drop_message(channel);
+		return NULL;
+	}
+
+	channel->index++;
+	return channel;
+}
+
+void cobs_demux_feed(struct cobs_demux *demux, const void *data, size_t length)
+{
+	const uint8_t *input = data;
+
+	while (length > 0) {
+		if (demux->discard) {
+			const uint8_t *const zero = memchr(input, 0, length);
+			if (!zero) {
+				break;
+			}
+
+			length -= zero + 1 - input;
+			input = zero + 1;
+			end_sub_frame(demux);
+			continue;
+		}
+
+		/* Delimiters between sub-frames. */
+		if (!demux->started && input[0] == 0) {
+			input++;
+			length--;
+			continue;
+		}
+
+		/* The header is decoded on its own, the rest of the sub-frame
+		 * directly into the buffer of its channel.
+		 */
+		struct cobs_demux_channel *channel = NULL;
+		uint8_t *output = &demux->header[demux->header_length];
+		size_t output_size = Z_COBS_MUX_HEADER_SIZE - demux->header_length;
+
+		if (demux->header_length == Z_COBS_MUX_HEADER_SIZE) {
+			channel = &demux->channels[demux->header[0]];
+			output = &channel->buffer[channel->length];
+			output_size = channel->size - channel->length;
+		}
+
+		size_t num_read;
+		size_t num_written;
+		enum cobs_decode_result result = cobs_decode_stream(
+			&demux->decode, input, length, output, output_size, &num_read, &num_written);
+
+		input += num_read;
+		length -= num_read;
+		demux->started = true;
+
+		if (!channel) {
+			demux->header_length += num_written;
+
+			if (demux->header_length == Z_COBS_MUX_HEADER_SIZE && !start_message(demux)) {
+				if (result == COBS_DECODE_RESULT_CONSUMED) {
+					demux->discard = true;
+				} else {
+					end_sub_frame(demux);
+				}
+				continue;
+			}
+		} else {
+			channel->length += num_written;
+
+			if (result == COBS_DECODE_RESULT_CONSUMED && length > 0) {
+				/* The buffer is full. The message still fits if
+				 * the next byte is a code which doesn't add a zero.
+				 */
+				uint8_t output_byte;
+				bool output_available;
+
+				result = cobs_decode_stream_single(&demux->decode, input[0],
+								   &output_byte, &output_available);
+				input++;
+				length--;
+
+				if (output_available) {
+					drop_message(channel);
+					demux->discard = true;
+					continue;
+				}
+			}
+		}
+
+		switch (result) {
+		case COBS_DECODE_RESULT_CONSUMED:
+			break;
+
+		case COBS_DECODE_RESULT_FINISHED:
+			/* Sub-frames without a complete header are ignored. */
+			if (demux->header_length == Z_COBS_MUX_HEADER_SIZE) {
+				channel = &demux->channels[demux->header[0]];
+
+				if (demux->header[1] & Z_COBS_MUX_LAST) {
+					demux->cb(demux, demux->header[0], channel->buffer,
+						  channel->length);
+					drop_message(channel);
+				}
+			}
+			end_sub_frame(demux);
+			break;
+
+		case COBS_DECODE_RESULT_UNEXPECTED_ZERO:
+		case COBS_DECODE_RESULT_ERROR:
+		default:
+			if (demux->header_length == Z_COBS_MUX_HEADER_SIZE) {
+				drop_message(&demux->channels[demux->header[0]]);
+			}
+			end_sub_frame(demux);
+			break;
+		}
+	}
+}
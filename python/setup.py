@@ -0,0 +1,37 @@
+# SPDX-License-Identifier: MIT
+
+import shutil
+from pathlib import Path
+
+from setuptools import Extension, setup
+
+# The library lives in the parent directory. It is copied into the package,
+# so that all sources are relative to it and a source distribution is
+# complete on its own.
+root = Path(__file__).resolve().parent.parent
+lib = Path(__file__).resolve().parent / "lib"
+
+if (root / "cobs.c").exists():
+    for source in ("cobs.c", "stream.c"):
+        lib.mkdir(exist_ok=True)
+        shutil.copy2(root / source, lib / source)
+    shutil.copytree(root / "include", lib / "include", dirs_exist_ok=True)
+
+setup(
+    name="zcobs",
+    version="0.1.0",
+    description="Consistent Overhead Byte Stuffing, implemented in C",
+    license="MIT",
+    python_requires=">=3.10",
+    ext_modules=[
+        Extension(
+            "zcobs",
+            sources=["zcobs.c", "lib/cobs.c", "lib/stream.c"],
+            include_dirs=["lib/include"],
+            define_macros=[
+                ("CONFIG_COBS_PROFILE_SPEED", None),
+                ("CONFIG_COBS_DECODE_INPLACE", None),
+            ],
+        )
+    ],
+)
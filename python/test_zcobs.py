@@ -0,0 +1,144 @@
+# SPDX-License-Identifier: MIT
+
+import random
+import threading
+import unittest
+
+import zcobs
+
+try:
+    from cobs import cobs
+except ImportError:
+    cobs = None
+
+VECTORS = [
+    (b"", b"\x01"),
+    (b"\x00", b"\x01\x01"),
+    (b"\x00\x00", b"\x01\x01\x01"),
+    (b"\x11\x22\x00\x33", b"\x03\x11\x22\x02\x33"),
+    (b"\x11\x00\x00\x00", b"\x02\x11\x01\x01\x01"),
+    (bytes(range(1, 255)), b"\xff" + bytes(range(1, 255))),
+    (bytes(range(1, 256)), b"\xff" + bytes(range(1, 255)) + b"\x02\xff"),
+]
+
+
+def random_data(rng, length):
+    return bytes(rng.choice((0, rng.randrange(256))) for _ in range(length))
+
+
+class TestCodec(unittest.TestCase):
+    def test_vectors(self):
+        for decoded, encoded in VECTORS:
+            self.assertEqual(zcobs.encode(decoded), encoded)
+            self.assertEqual(zcobs.decode(encoded), decoded)
+
+    def test_buffer_types(self):
+        decoded, encoded = VECTORS[3]
+
+        for data in (
+            bytearray(decoded),
+            memoryview(decoded),
+            memoryview(decoded * 2)[:4],
+        ):
+            self.assertEqual(zcobs.encode(data), encoded)
+
+        self.assertEqual(zcobs.decode(bytearray(encoded)), decoded)
+        self.assertEqual(zcobs.decode(memoryview(b"\x00" + encoded)[1:]), decoded)
+
+        with self.assertRaises(TypeError):
+            zcobs.encode("text")
+
+    def test_invalid(self):
+        for encoded in (b"\x00", b"\x03\x11", b"\x03\x11\x00\x22"):
+            with self.assertRaises(zcobs.DecodeError):
+                zcobs.decode(encoded)
+
+    def test_roundtrip(self):
+        rng = random.Random(0)
+
+        for length in (1, 253, 254, 255, 1000, 10000, 100000):
+            data = random_data(rng, length)
+            encoded = zcobs.encode(data)
+
+            self.assertNotIn(0, encoded)
+            self.assertEqual(zcobs.decode(encoded), data)
+
+            if cobs:
+                self.assertEqual(encoded, cobs.encode(data))
+
+    def test_decode_inplace(self):
+        decoded, encoded = VECTORS[3]
+        data = bytearray(encoded)
+
+        self.assertEqual(zcobs.decode_inplace(data), len(decoded))
+        self.assertEqual(data[: len(decoded)], decoded)
+
+        with self.assertRaises(TypeError):
+            zcobs.decode_inplace(encoded)
+
+        with self.assertRaises(zcobs.DecodeError):
+            zcobs.decode_inplace(bytearray(b"\x03\x11"))
+
+
+class TestDecoder(unittest.TestCase):
+    def test_chunks(self):
+        rng = random.Random(1)
+        frames = [random_data(rng, rng.randrange(300)) for _ in range(100)]
+        stream = b"".join(b"\x00" + zcobs.encode(frame) + b"\x00" for frame in frames)
+
+        for chunk_size in (1, 7, len(stream)):
+            decoder = zcobs.Decoder(max_size=300)
+            received = []
+
+            for i in range(0, len(stream), chunk_size):
+                received += decoder.feed(stream[i : i + chunk_size])
+
+            self.assertEqual(received, frames)
+            self.assertEqual(decoder.errors, 0)
+
+    def test_errors(self):
+        decoder = zcobs.Decoder(max_size=4)
+        stream = (
+            zcobs.encode(b"\x11\x22\x33\x44\x55")
+            + b"\x00\x03\x11\x00"
+            + zcobs.encode(b"\x11\x22\x33\x44")
+            + b"\x00"
+        )
+
+        self.assertEqual(decoder.feed(stream), [b"\x11\x22\x33\x44"])
+        self.assertEqual(decoder.errors, 2)
+
+    def test_reset(self):
+        decoder = zcobs.Decoder()
+
+        self.assertEqual(decoder.feed(b"\x03\x11"), [])
+        decoder.reset()
+        self.assertEqual(decoder.feed(b"\x02\x22\x00"), [b"\x22"])
+
+        with self.assertRaises(ValueError):
+            zcobs.Decoder(max_size=0)
+
+    def test_threads(self):
+        rng = random.Random(2)
+        frame = random_data(rng, 50000)
+        stream = memoryview((zcobs.encode(frame) + b"\x00") * 20)
+
+        def worker(results):
+            decoder = zcobs.Decoder(max_size=len(frame))
+            results += decoder.feed(stream)
+
+        results = [[] for _ in range(4)]
+        threads = [threading.Thread(target=worker, args=(r,)) for r in results]
+
+        for thread in threads:
+            thread.start()
+
+        for thread in threads:
+            thread.join()
+
+        for result in results:
+            self.assertEqual(result, [frame] * 20)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,466 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * CPython bindings of the encoder and decoders. All functions take any object
+ * with a contiguous buffer, like bytes, bytearray, memoryview or NumPy arrays,
+ * without copying it.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <structmember.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <cobs.h>
+
+/* Inputs of at least this many bytes are processed without holding the GIL,
+ * below that, releasing and taking it again costs more than it gains.
+ */
+#define GIL_RELEASE_THRESHOLD 4096
+
+#define DEFAULT_MAX_SIZE 65536
+
+static PyObject *decode_error;
+
+static PyObject *zcobs_encode(PyObject *module, PyObject *args)
+{
+	Py_buffer input;
+
+	if (!PyArg_ParseTuple(args, "y*:encode", &input)) {
+		return NULL;
+	}
+
+	PyObject *const output = PyBytes_FromStringAndSize(NULL, COBS_MAX_ENCODED_SIZE(input.len));
+	if (!output) {
+		PyBuffer_Release(&input);
+		return NULL;
+	}
+
+	uint8_t *const output_data = (uint8_t *)PyBytes_AS_STRING(output);
+	size_t length;
+
+	if (input.len >= GIL_RELEASE_THRESHOLD) {
+		Py_BEGIN_ALLOW_THREADS
+		length = cobs_encode(input.buf, input.len, output_data);
+		Py_END_ALLOW_THREADS
+	} else {
+		length = cobs_encode(input.buf, input.len, output_data);
+	}
+
+	PyBuffer_Release(&input);
+
+	PyObject *result = output;
+	if (_PyBytes_Resize(&result, (Py_ssize_t)length) < 0) {
+		return NULL;
+	}
+
+	return result;
+}
+
+static PyObject *zcobs_decode(PyObject *module, PyObject *args)
+{
+	Py_buffer input;
+
+	if (!PyArg_ParseTuple(args, "y*:decode", &input)) {
+		return NULL;
+	}
+
+	PyObject *const output = PyBytes_FromStringAndSize(NULL, input.len);
+	if (!output) {
+		PyBuffer_Release(&input);
+		return NULL;
+	}
+
+	uint8_t *const output_data = (uint8_t *)PyBytes_AS_STRING(output);
+	size_t length;
+	int ret;
+
+	if (input.len >= GIL_RELEASE_THRESHOLD) {
+		Py_BEGIN_ALLOW_THREADS
+		ret = cobs_decode(input.buf, input.len, output_data, &length);
+		Py_END_ALLOW_THREADS
+	} else {
+		ret = cobs_decode(input.buf, input.len, output_data, &length);
+	}
+
+	PyBuffer_Release(&input);
+
+	if (ret < 0) {
+		Py_DECREF(output);
+		PyErr_SetString(decode_error, "invalid COBS data");
+		return NULL;
+	}
+
+	PyObject *result = output;
+	if (_PyBytes_Resize(&result, (Py_ssize_t)length) < 0) {
+		return NULL;
+	}
+
+	return result;
+}
+
+static PyObject *zcobs_decode_inplace(PyObject *module, PyObject *args)
+{
+	Py_buffer data;
+
+	if (!PyArg_ParseTuple(args, "w*:decode_inplace", &data)) {
+		return NULL;
+	}
+
+	size_t length;
+	int ret;
+
+	if (data.len >= GIL_RELEASE_THRESHOLD) {
+		Py_BEGIN_ALLOW_THREADS
+		ret = cobs_decode_inplace(data.buf, data.len, &length);
+		Py_END_ALLOW_THREADS
+	} else {
+		ret = cobs_decode_inplace(data.buf, data.len, &length);
+	}
+
+	PyBuffer_Release(&data);
+
+	if (ret < 0) {
+		PyErr_SetString(decode_error, "invalid COBS data");
+		return NULL;
+	}
+
+	return PyLong_FromSize_t(length);
+}
+
+typedef struct {
+	PyObject_HEAD
+	/* Decoder of the current frame. */
+	struct cobs_decode decode;
+	/* The current frame. */
+	uint8_t *buffer;
+	/* Size of `buffer`, the largest frame which can be decoded. */
+	Py_ssize_t size;
+	/* Number of bytes within `buffer`. */
+	Py_ssize_t length;
+	/* Number of frames which were invalid or too long. */
+	unsigned long long errors;
+	/* If true, bytes of the current frame were received. */
+	bool started;
+	/* If true, the input is skipped up to the next zero-byte. */
+	bool discard;
+	/* If true, a call of feed() is running without the GIL. */
+	bool busy;
+} DecoderObject;
+
+static void decoder_end_frame(DecoderObject *self)
+{
+	self->length = 0;
+	self->started = false;
+	self->discard = false;
+	cobs_decode_reset(&self->decode);
+}
+
+static int decoder_init(DecoderObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = {"max_size", NULL};
+	Py_ssize_t max_size = DEFAULT_MAX_SIZE;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n:Decoder", kwlist, &max_size)) {
+		return -1;
+	}
+
+	if (max_size <= 0) {
+		PyErr_SetString(PyExc_ValueError, "max_size must be positive");
+		return -1;
+	}
+
+	if (self->busy) {
+		PyErr_SetString(PyExc_RuntimeError, "Decoder is used by another thread");
+		return -1;
+	}
+
+	uint8_t *const buffer = PyMem_Realloc(self->buffer, max_size);
+	if (!buffer) {
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	self->buffer = buffer;
+	self->size = max_size;
+	self->errors = 0;
+	decoder_end_frame(self);
+
+	return 0;
+}
+
+static void decoder_dealloc(DecoderObject *self)
+{
+	PyMem_Free(self->buffer);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/* Frames which were completed by one call of feed(). */
+struct decoded_frames {
+	/* The frames, one after the other. */
+	uint8_t *data;
+	/* Number of bytes within `data`. */
+	size_t length;
+	/* Offset of the end of each frame within `data`. */
+	size_t *ends;
+	/* Number of frames. */
+	size_t count;
+	/* Number of elements of `ends`. */
+	size_t capacity;
+};
+
+/* Decode `length` bytes of `input` and append the completed frames to
+ * `frames`, whose `data` has to hold the current frame and `length` bytes.
+ * Only uses the raw allocator, so it can run without the GIL.
+ *
+ * Returns 0 on success or -1 if no memory was available.
+ */
+static int decoder_run(DecoderObject *self, const uint8_t *input, size_t length,
+		       struct decoded_frames *frames)
+{
+	while (length > 0) {
+		if (self->discard) {
+			const uint8_t *const zero = memchr(input, 0, length);
+			if (!zero) {
+				break;
+			}
+
+			length -= zero + 1 - input;
+			input = zero + 1;
+			decoder_end_frame(self);
+			continue;
+		}
+
+		/* Delimiters between frames. */
+		if (!self->started && input[0] == 0) {
+			input++;
+			length--;
+			continue;
+		}
+
+		if (frames->count == frames->capacity) {
+			const size_t capacity = frames->capacity * 2;
+			size_t *const ends =
+				PyMem_RawRealloc(frames->ends, capacity * sizeof(*ends));
+
+			if (!ends) {
+				return -1;
+			}
+
+			frames->ends = ends;
+			frames->capacity = capacity;
+		}
+
+		uint8_t *const output = &self->buffer[self->length];
+		const size_t output_size = self->size - self->length;
+		size_t num_read;
+		size_t num_written;
+		enum cobs_decode_result result = cobs_decode_stream(
+			&self->decode, input, length, output, output_size, &num_read, &num_written);
+
+		input += num_read;
+		length -= num_read;
+		self->length += num_written;
+		self->started = true;
+
+		if (result == COBS_DECODE_RESULT_CONSUMED && length > 0) {
+			/* The buffer is full. The frame still fits if the next
+			 * byte is a code which doesn't add a zero.
+			 */
+			uint8_t output_byte;
+			bool output_available;
+
+			result = cobs_decode_stream_single(&self->decode, input[0], &output_byte,
+							   &output_available);
+			input++;
+			length--;
+
+			if (output_available) {
+				self->errors++;
+				self->discard = true;
+				continue;
+			}
+		}
+
+		switch (result) {
+		case COBS_DECODE_RESULT_CONSUMED:
+			break;
+
+		case COBS_DECODE_RESULT_FINISHED:
+			memcpy(&frames->data[frames->length], self->buffer, self->length);
+			frames->length += self->length;
+			frames->ends[frames->count++] = frames->length;
+			decoder_end_frame(self);
+			break;
+
+		case COBS_DECODE_RESULT_UNEXPECTED_ZERO:
+		case COBS_DECODE_RESULT_ERROR:
+		default:
+			self->errors++;
+			decoder_end_frame(self);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static PyObject *decoder_feed(DecoderObject *self, PyObject *args)
+{
+	Py_buffer data;
+
+	if (!PyArg_ParseTuple(args, "y*:feed", &data)) {
+		return NULL;
+	}
+
+	if (self->busy) {
+		PyBuffer_Release(&data);
+		PyErr_SetString(PyExc_RuntimeError, "Decoder is used by another thread");
+		return NULL;
+	}
+
+	/* Only the first frame may contain bytes of earlier calls, the bytes
+	 * of all others are decoded from `data`, which doesn't grow.
+	 */
+	struct decoded_frames frames = {
+		.data = PyMem_RawMalloc(self->length + data.len + 1),
+		.ends = PyMem_RawMalloc(16 * sizeof(size_t)),
+		.capacity = 16,
+	};
+	PyObject *list = NULL;
+	int ret;
+
+	if (!frames.data || !frames.ends) {
+		PyErr_NoMemory();
+		goto out;
+	}
+
+	if (data.len >= GIL_RELEASE_THRESHOLD) {
+		self->busy = true;
+		Py_BEGIN_ALLOW_THREADS
+		ret = decoder_run(self, data.buf, data.len, &frames);
+		Py_END_ALLOW_THREADS
+		self->busy = false;
+	} else {
+		ret = decoder_run(self, data.buf, data.len, &frames);
+	}
+
+	if (ret < 0) {
+		PyErr_NoMemory();
+		goto out;
+	}
+
+	list = PyList_New((Py_ssize_t)frames.count);
+	if (!list) {
+		goto out;
+	}
+
+	for (size_t i = 0, start = 0; i < frames.count; start = frames.ends[i++]) {
+		PyObject *const frame = PyBytes_FromStringAndSize(
+			(const char *)&frames.data[start], (Py_ssize_t)(frames.ends[i] - start));
+
+		if (!frame) {
+			Py_CLEAR(list);
+			goto out;
+		}
+
+		PyList_SET_ITEM(list, (Py_ssize_t)i, frame);
+	}
+
+out:
+	PyMem_RawFree(frames.ends);
+	PyMem_RawFree(frames.data);
+	PyBuffer_Release(&data);
+	return list;
+}
+
+static PyObject *decoder_reset(DecoderObject *self, PyObject *Py_UNUSED(args))
+{
+	if (self->busy) {
+		PyErr_SetString(PyExc_RuntimeError, "Decoder is used by another thread");
+		return NULL;
+	}
+
+	decoder_end_frame(self);
+	Py_RETURN_NONE;
+}
+
+static PyMethodDef decoder_methods[] = {
+	{"feed", (PyCFunction)decoder_feed, METH_VARARGS,
+	 "feed(data) -> list[bytes]\n\n"
+	 "Decode received data and return the frames which were completed.\n"
+	 "Zero-bytes outside of frames are skipped, invalid frames and frames\n"
+	 "longer than max_size are dropped and counted in errors."},
+	{"reset", (PyCFunction)decoder_reset, METH_NOARGS,
+	 "reset()\n\nDrop the frame being decoded, e.g. after a receive error."},
+	{NULL, NULL, 0, NULL},
+};
+
+static PyMemberDef decoder_members[] = {
+	{"errors", T_ULONGLONG, offsetof(DecoderObject, errors), READONLY,
+	 "Number of frames which were dropped."},
+	{"max_size", T_PYSSIZET, offsetof(DecoderObject, size), READONLY,
+	 "Size of the largest frame which can be decoded."},
+	{NULL},
+};
+
+static PyTypeObject decoder_type = {
+	PyVarObject_HEAD_INIT(NULL, 0).tp_name = "zcobs.Decoder",
+	.tp_doc = PyDoc_STR("Decoder(max_size=65536)\n\n"
+			    "Streaming decoder for frames separated by zero-bytes."),
+	.tp_basicsize = sizeof(DecoderObject),
+	.tp_itemsize = 0,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_new = PyType_GenericNew,
+	.tp_init = (initproc)decoder_init,
+	.tp_dealloc = (destructor)decoder_dealloc,
+	.tp_methods = decoder_methods,
+	.tp_members = decoder_members,
+};
+
+static PyMethodDef zcobs_methods[] = {
+	{"encode", zcobs_encode, METH_VARARGS,
+	 "encode(data) -> bytes\n\nEncode data into a frame, without the delimiter."},
+	{"decode", zcobs_decode, METH_VARARGS,
+	 "decode(data) -> bytes\n\n"
+	 "Decode a frame without its delimiter. Raises DecodeError if it's invalid."},
+	{"decode_inplace", zcobs_decode_inplace, METH_VARARGS,
+	 "decode_inplace(data) -> int\n\n"
+	 "Decode a frame without its delimiter within the writable buffer data.\n"
+	 "Returns the decoded length. Raises DecodeError if it's invalid."},
+	{NULL, NULL, 0, NULL},
+};
+
+static struct PyModuleDef zcobs_module = {
+	PyModuleDef_HEAD_INIT,
+	.m_name = "zcobs",
+	.m_doc = PyDoc_STR("Consistent Overhead Byte Stuffing, implemented in C."),
+	.m_size = -1,
+	.m_methods = zcobs_methods,
+};
+
+PyMODINIT_FUNC PyInit_zcobs(void)
+{
+	if (PyType_Ready(&decoder_type) < 0) {
+		return NULL;
+	}
+
+	PyObject *const module = PyModule_Create(&zcobs_module);
+	if (!module) {
+		return NULL;
+	}
+
+	decode_error = PyErr_NewExceptionWithDoc("zcobs.DecodeError", "Invalid COBS data.",
+						 PyExc_ValueError, NULL);
+	if (!decode_error || PyModule_AddObjectRef(module, "DecodeError", decode_error) < 0 ||
+	    PyModule_AddObjectRef(module, "Decoder", (PyObject *)&decoder_type) < 0) {
+		Py_XDECREF(decode_error);
+		Py_DECREF(module);
+		return NULL;
+	}
+
+	return module;
+}
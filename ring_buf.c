@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <stdint.h>
+#include <cobs/ring_buf.h>
+
+#if KERNEL_VERSION_NUMBER < 0x30100
+#include <sys/__assert.h>
+#else
+#include <zephyr/sys/__assert.h>
+#endif
+
+enum cobs_decode_result cobs_decode_ring_buf(struct cobs_decode *decode, struct ring_buf *input,
+					     uint8_t *output, size_t output_size,
+					     size_t *num_written)
+{
+	enum cobs_decode_result result = COBS_DECODE_RESULT_CONSUMED;
+
+	*num_written = 0;
+
+	/* At most two iterations are needed: one for the data up to the end of
+	 * the ring's memory and one for the data that wrapped around.
+	 */
+	for (;;) {
+		uint8_t *data;
+		const uint32_t claimed = ring_buf_get_claim(input, &data, UINT32_MAX);
+		if (claimed == 0) {
+			break;
+		}
+
+		size_t span_read;
+		size_t span_written;
+		result = cobs_decode_stream(decode, data, claimed, output, output_size, &span_read,
+					    &span_written);
+
+		int ret = ring_buf_get_finish(input, span_read);
+		__ASSERT_NO_MSG(ret == 0);
+		(void)ret;
+
+		output += span_written;
+		output_size -= span_written;
+		*num_written += span_written;
+
+		if (result != COBS_DECODE_RESULT_CONSUMED || span_read < claimed) {
+			break;
+		}
+	}
+
+	return result;
+}
+
+size_t cobs_encode_ring_buf(struct cobs_encode *encode, struct ring_buf *output)
+{
+	size_t num_written = 0;
+
+	for (;;) {
+		uint8_t *data;
+		const uint32_t claimed = ring_buf_put_claim(output, &data, UINT32_MAX);
+		if (claimed == 0) {
+			break;
+		}
+
+		const size_t span_written = cobs_encode_stream(encode, data, claimed);
+
+		int ret = ring_buf_put_finish(output, span_written);
+		__ASSERT_NO_MSG(ret == 0);
+		(void)ret;
+
+		num_written += span_written;
+
+		if (span_written < claimed) {
+			break;
+		}
+	}
+
+	return num_written;
+}
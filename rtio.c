@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/rtio/rtio.h>
+#include <cobs.h>
+#include <cobs/rtio.h>
+
+static void cobs_rtio_encode_submit(struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *const sqe = &iodev_sqe->sqe;
+	const struct cobs_rtio_encoder_data *const data = sqe->iodev->data;
+
+	if (sqe->op != RTIO_OP_TX) {
+		rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+		return;
+	}
+
+	if (COBS_RTIO_ENCODED_SIZE(sqe->buf_len) > data->size) {
+		rtio_iodev_sqe_err(iodev_sqe, -EMSGSIZE);
+		return;
+	}
+
+	size_t length = cobs_encode(sqe->buf, sqe->buf_len, data->buffer);
+
+	data->buffer[length++] = 0x00;
+
+	/* The next entry is only submitted once this one completed. */
+	struct rtio_iodev_sqe *const next = iodev_sqe->next;
+
+	if ((sqe->flags & RTIO_SQE_CHAINED) && next && next->sqe.op == RTIO_OP_TX &&
+	    next->sqe.buf == data->buffer) {
+		next->sqe.buf_len = length;
+	}
+
+	rtio_iodev_sqe_ok(iodev_sqe, (int)length);
+}
+
+static void cobs_rtio_decode_submit(struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *const sqe = &iodev_sqe->sqe;
+
+	if (sqe->op != RTIO_OP_TXRX) {
+		rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+		return;
+	}
+
+	const uint8_t *input = sqe->tx_buf;
+	size_t length = sqe->txrx_buf_len;
+
+	/* Delimiters in front of the frame. */
+	while (length > 0 && input[0] == 0) {
+		input++;
+		length--;
+	}
+
+	const uint8_t *const zero = memchr(input, 0, length);
+	if (zero) {
+		length = zero - input;
+	}
+
+	size_t decoded_size;
+
+	if (length == 0 || cobs_decode(input, length, sqe->rx_buf, &decoded_size) < 0) {
+		rtio_iodev_sqe_err(iodev_sqe, -EINVAL);
+		return;
+	}
+
+	rtio_iodev_sqe_ok(iodev_sqe, (int)decoded_size);
+}
+
+const struct rtio_iodev_api cobs_rtio_encoder_api = {
+	.submit = cobs_rtio_encode_submit,
+};
+
+static const struct rtio_iodev_api cobs_rtio_decoder_api = {
+	.submit = cobs_rtio_decode_submit,
+};
+
+RTIO_IODEV_DEFINE(cobs_rtio_decoder, &cobs_rtio_decoder_api, NULL);
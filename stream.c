@@ -5,84 +5,74 @@
 #include <stdint.h>
 #include <string.h>
 #include <cobs.h>
-
-static inline struct cobs_buf_cursor cobs_buf_cursor_new(struct net_buf *buf)
+#include <cobs/scan.h>
+
+#ifdef __ZEPHYR__
+#if KERNEL_VERSION_NUMBER < 0x30100
+#include <kernel.h>
+#include <sys/__assert.h>
+#else
+#include <zephyr/kernel.h>
+#include <zephyr/sys/__assert.h>
+#endif
+#endif
+
+#ifdef CONFIG_COBS_PROFILE_SIZE
+#define Z_COBS_HOT
+#else
+#define Z_COBS_HOT ALWAYS_INLINE
+#endif
+
+static size_t cobs_mem_source_span(struct cobs_encode_source *source, const uint8_t **data)
 {
-	return (struct cobs_buf_cursor){
-		.buf = net_buf_ref(buf),
-		.offset = 0,
-	};
+	struct cobs_mem_source *const mem = CONTAINER_OF(source, struct cobs_mem_source, source);
+
+	*data = mem->data + mem->offset;
+	return mem->length - mem->offset;
 }
 
-static void cobs_buf_cursor_delete(struct cobs_buf_cursor *cursor)
+static void cobs_mem_source_advance(struct cobs_encode_source *source, size_t length)
 {
-	if (cursor->buf) {
-		net_buf_unref(cursor->buf);
-		cursor->buf = NULL;
-	}
+	struct cobs_mem_source *const mem = CONTAINER_OF(source, struct cobs_mem_source, source);
 
-	cursor->offset = 0;
+	__ASSERT_NO_MSG(mem->offset + length <= mem->length);
+	mem->offset += length;
 }
 
-static int cobs_buf_cursor_read(struct cobs_buf_cursor *const cursor, void *const output_,
-				size_t length)
+static int cobs_mem_source_find_zero(struct cobs_encode_source *source, size_t max_length,
+				     size_t *offset)
 {
-	uint8_t *output = output_;
-
-	while (cursor->buf && length) {
-		struct net_buf *const buf = cursor->buf;
-		const size_t read_length = MIN(buf->len - cursor->offset, length);
-		if (read_length == 0) {
-			if (buf->frags) {
-				cursor->buf = net_buf_ref(buf->frags);
-				net_buf_unref(buf);
-			} else {
-				cursor->buf = NULL;
-				net_buf_unref(buf);
-			}
-			cursor->offset = 0;
-			continue;
-		}
-
-		memcpy(output, buf->data + cursor->offset, read_length);
-		output += read_length;
-		length -= read_length;
-		cursor->offset += read_length;
-	}
-
-	if (length) {
-		return -ENOBUFS;
+	struct cobs_mem_source *const mem = CONTAINER_OF(source, struct cobs_mem_source, source);
+	const uint8_t *const data = mem->data + mem->offset;
+	const size_t length = MIN(mem->length - mem->offset, max_length);
+
+	const uint8_t *const zero = z_cobs_find_zero(data, length);
+	if (zero) {
+		*offset = (size_t)(zero - data);
+		return 0;
 	}
 
-	return 0;
+	*offset = length;
+	return -ENOENT;
 }
 
-static int cursor_find_zero(struct cobs_buf_cursor *cursor, size_t *num_processed,
-			    size_t *zero_position)
-{
-	size_t offset = 0;
-
-	struct net_buf *buf = cursor->buf;
-	size_t start_offset = cursor->offset;
-	while (buf) {
-		for (uint16_t i = start_offset; i < buf->len; i += 1, offset += 1) {
-			if (buf->data[i] == 0) {
-				*num_processed = offset + 1;
-				*zero_position = offset;
-				return 0;
-			}
-		}
-
-		buf = buf->frags;
-		start_offset = 0;
-	}
+static const struct cobs_encode_source_api cobs_mem_source_api = {
+	.span = cobs_mem_source_span,
+	.advance = cobs_mem_source_advance,
+	.find_zero = cobs_mem_source_find_zero,
+};
 
-	*num_processed = offset;
-	return -ENOENT;
+void cobs_mem_source_init(struct cobs_mem_source *source, const void *data, size_t length)
+{
+	*source = (struct cobs_mem_source){
+		.source.api = &cobs_mem_source_api,
+		.data = data,
+		.length = length,
+	};
 }
 
 /* NOTE: It's important to inline this, to make cobs_decode_stream faster. */
-ALWAYS_INLINE
+Z_COBS_HOT
 enum cobs_decode_result cobs_decode_stream_single(struct cobs_decode *decode, uint8_t input_byte,
 						  uint8_t *output_byte, bool *output_available)
 {
@@ -141,6 +131,32 @@ enum cobs_decode_result cobs_decode_stream(struct cobs_decode *decode, const uin
 	*num_written = 0;
 
 	while (input_size > 0 && (output_size > 0 || input[0] == 0)) {
+#ifdef CONFIG_COBS_PROFILE_SPEED
+		/* Copy as much data of the current block as possible at once and
+		 * leave zero-bytes, codes and the end of the block to
+		 * cobs_decode_stream_single.
+		 */
+		if (decode->state == COBS_DECODE_STATE_DATA) {
+			const size_t max_length = MIN(MIN(input_size, output_size), decode->code);
+			const size_t length = z_cobs_copy_nonzero(output, input, max_length);
+
+			if (length > 0) {
+				*num_read += length;
+				*num_written += length;
+				input += length;
+				input_size -= length;
+				output += length;
+				output_size -= length;
+
+				decode->code -= length;
+				if (decode->code == 0) {
+					decode->state = COBS_DECODE_STATE_CODE;
+				}
+				continue;
+			}
+		}
+#endif
+
 		bool output_available = false;
 		enum cobs_decode_result result =
 			cobs_decode_stream_single(decode, input[0], output, &output_available);
@@ -163,198 +179,333 @@ enum cobs_decode_result cobs_decode_stream(struct cobs_decode *decode, const uin
 	return COBS_DECODE_RESULT_CONSUMED;
 }
 
-void cobs_encode_stream_init(struct cobs_encode *encode, struct net_buf *buf)
+static uint32_t cobs_decode_clock(const struct cobs_decode_timed *decode)
 {
-	*encode = (struct cobs_encode){
-		.cursor = cobs_buf_cursor_new(buf),
-	};
+#ifdef __ZEPHYR__
+	if (!decode->clock) {
+		return k_cycle_get_32();
+	}
+#endif
+
+	return decode->clock();
+}
+
+enum cobs_decode_result cobs_decode_stream_timed(struct cobs_decode_timed *decode,
+						 const uint8_t *input, size_t input_size,
+						 uint8_t *output, size_t output_size, size_t *num_read,
+						 size_t *num_written,
+						 struct cobs_decode_timestamps *timestamps)
+{
+	const uint32_t now = input_size > 0 ? cobs_decode_clock(decode) : 0;
 
-	size_t num_processed;
-	size_t zero_position;
-	int ret = cursor_find_zero(&encode->cursor, &num_processed, &zero_position);
-	if (ret == 0) {
-		__ASSERT_NO_MSG(num_processed != 0);
+	const enum cobs_decode_result result = cobs_decode_stream(
+		&decode->decode, input, input_size, output, output_size, num_read, num_written);
 
-		encode->state = zero_position ? COBS_ENCODE_STATE_ZEROS_CODE
-					      : COBS_ENCODE_STATE_ZEROS_FIRSTBYTE;
-		encode->u.zeros = (struct cobs_encode_zeros){
-			.next_zero = zero_position,
-		};
-	} else {
-		encode->state = COBS_ENCODE_STATE_NOZEROS_CODE;
-		encode->u.nozeros = (struct cobs_encode_nozeros){
-			.total_length = num_processed,
+	if (*num_read == 0) {
+		return result;
+	}
+
+	if (!decode->started) {
+		decode->first_byte = now;
+		decode->started = true;
+	}
+
+	if (result == COBS_DECODE_RESULT_FINISHED) {
+		*timestamps = (struct cobs_decode_timestamps){
+			.first_byte = decode->first_byte,
+			.delimiter = now,
 		};
 	}
+
+	return result;
+}
+
+void cobs_encode_stream_init_source(struct cobs_encode *encode, struct cobs_encode_source *source)
+{
+	encode->source = source;
+	encode->state = COBS_ENCODE_STATE_CODE;
+	encode->code = 0;
+	encode->data_left = 0;
 }
 
 void cobs_encode_stream_free(struct cobs_encode *encode)
 {
-	cobs_buf_cursor_delete(&encode->cursor);
-	*encode = (struct cobs_encode){};
+	struct cobs_encode_source *const source = encode->source;
+
+	if (source && source->api->release) {
+		source->api->release(source);
+	}
+
+	*encode = (struct cobs_encode){
+		.state = COBS_ENCODE_STATE_FINISHED,
+	};
 }
 
-static inline bool cobs_encode_stream_single(struct cobs_encode *encode, uint8_t *output)
+static void cobs_encode_stream_end_block(struct cobs_encode *encode)
 {
-	int ret;
-
-	switch (encode->state) {
-	case COBS_ENCODE_STATE_ZEROS_FIRSTBYTE:
-		*output = 0x01;
-		encode->state = COBS_ENCODE_STATE_ZEROS_CODE;
-		break;
-	case COBS_ENCODE_STATE_ZEROS_CODE: {
-		if (encode->u.zeros.next_zero == 0) {
-			uint8_t zero;
-			ret = cobs_buf_cursor_read(&encode->cursor, &zero, sizeof(zero));
-			__ASSERT_NO_MSG(ret == 0);
-			ARG_UNUSED(ret);
-
-			__ASSERT_NO_MSG(zero == 0);
-
-			size_t num_processed;
-			size_t zero_position;
-			int ret = cursor_find_zero(&encode->cursor, &num_processed, &zero_position);
-			if (num_processed == 0) {
-				*output = 0x01;
-				encode->state = COBS_ENCODE_STATE_FINAL_ZERO;
-			} else if (ret == 0) {
-				__ASSERT_NO_MSG(num_processed != 0);
-
-				encode->u.zeros.next_zero = zero_position;
-				if (encode->u.zeros.next_zero == 0) {
-					*output = 0x01;
-				} else if (encode->u.zeros.next_zero < 254) {
-					*output = encode->u.zeros.next_zero + 1;
-
-					encode->state = COBS_ENCODE_STATE_ZEROS_DATA;
-					encode->u.zeros.data_left = encode->u.zeros.next_zero;
-					encode->u.zeros.post_data_state =
-						COBS_ENCODE_STATE_ZEROS_CODE;
-				} else {
-					*output = 0xFF;
-
-					encode->state = COBS_ENCODE_STATE_ZEROS_DATA;
-					encode->u.zeros.data_left = 254;
-					if (encode->u.zeros.next_zero == 254) {
-						encode->u.zeros.post_data_state =
-							COBS_ENCODE_STATE_ZEROS_FIRSTBYTE;
-					} else {
-						encode->u.zeros.post_data_state =
-							COBS_ENCODE_STATE_ZEROS_CODE;
-					}
-				}
-			} else {
-				encode->state = COBS_ENCODE_STATE_NOZEROS_DATA;
-				encode->u.nozeros = (struct cobs_encode_nozeros){
-					.total_length = num_processed,
-				};
+	struct cobs_encode_source *const source = encode->source;
+	const uint8_t *data;
+
+	const size_t available = source->api->span(source, &data);
+	if (available == 0) {
+		encode->state = COBS_ENCODE_STATE_FINAL_ZERO;
+		return;
+	}
 
-				const size_t total_length = num_processed;
-				if (total_length < 254) {
-					*output = encode->u.nozeros.total_length + 1;
+	/* Blocks that are shorter than 254 bytes end with a zero. */
+	if (encode->code != 0xFF) {
+		__ASSERT_NO_MSG(data[0] == 0);
+		source->api->advance(source, 1);
+	}
 
-					encode->u.nozeros.data_left =
-						encode->u.nozeros.total_length;
-				} else {
-					*output = 0xFF;
+	encode->state = COBS_ENCODE_STATE_CODE;
+}
 
-					encode->u.nozeros.data_left = 254;
-				}
-			}
-		} else if (encode->u.zeros.next_zero < 254) {
-			*output = encode->u.zeros.next_zero + 1;
+size_t cobs_encode_stream(struct cobs_encode *encode, uint8_t *output, size_t output_length)
+{
+	struct cobs_encode_source *const source = encode->source;
+	size_t num_written = 0;
 
-			encode->state = COBS_ENCODE_STATE_ZEROS_DATA;
-			encode->u.zeros.data_left = encode->u.zeros.next_zero;
-			encode->u.zeros.post_data_state = COBS_ENCODE_STATE_ZEROS_CODE;
-		} else {
-			*output = 0xFF;
+	while (num_written < output_length) {
+		switch (encode->state) {
+		case COBS_ENCODE_STATE_CODE: {
+			size_t block_length;
 
-			encode->state = COBS_ENCODE_STATE_ZEROS_DATA;
-			encode->u.zeros.data_left = 254;
-			if (encode->u.zeros.next_zero == 254) {
-				encode->u.zeros.post_data_state = COBS_ENCODE_STATE_ZEROS_FIRSTBYTE;
+			(void)source->api->find_zero(source, 254, &block_length);
+			__ASSERT_NO_MSG(block_length <= 254);
+
+			encode->code = block_length + 1;
+			encode->data_left = block_length;
+			output[num_written++] = encode->code;
+
+			if (block_length) {
+				encode->state = COBS_ENCODE_STATE_DATA;
 			} else {
-				encode->u.zeros.post_data_state = COBS_ENCODE_STATE_ZEROS_CODE;
+				cobs_encode_stream_end_block(encode);
 			}
+			break;
 		}
 
-		break;
-	}
+		case COBS_ENCODE_STATE_DATA: {
+			const uint8_t *data;
+			const size_t available = source->api->span(source, &data);
+			__ASSERT_NO_MSG(available);
 
-	case COBS_ENCODE_STATE_ZEROS_DATA: {
-		ret = cobs_buf_cursor_read(&encode->cursor, output, 1);
-		__ASSERT_NO_MSG(ret == 0);
-		ARG_UNUSED(ret);
+			const size_t length =
+				MIN(MIN(available, encode->data_left), output_length - num_written);
+			memcpy(&output[num_written], data, length);
+			source->api->advance(source, length);
+			num_written += length;
+			encode->data_left -= length;
 
-		encode->u.zeros.data_left -= 1;
-		encode->u.zeros.next_zero -= 1;
+			if (encode->data_left == 0) {
+				cobs_encode_stream_end_block(encode);
+			}
+			break;
+		}
+
+		case COBS_ENCODE_STATE_FINAL_ZERO:
+			output[num_written++] = 0x00;
+			encode->state = COBS_ENCODE_STATE_FINISHED;
+			break;
 
-		if (encode->u.nozeros.data_left == 0) {
-			encode->state = encode->u.zeros.post_data_state;
+		case COBS_ENCODE_STATE_FINISHED:
+		default:
+			return num_written;
 		}
-		break;
 	}
 
-	case COBS_ENCODE_STATE_NOZEROS_CODE: {
-		if (encode->u.nozeros.total_length == 0) {
-			*output = 0x01;
+	return num_written;
+}
+
+static void cobs_encode_flat_end_block(struct cobs_encode_flat *encode)
+{
+	if (encode->read_index == encode->length) {
+		encode->state = COBS_ENCODE_FLAT_STATE_FINAL_ZERO;
+		return;
+	}
+
+	/* Blocks that are shorter than 254 bytes end with a zero. */
+	if (encode->code != 0xFF) {
+		__ASSERT_NO_MSG(encode->input[encode->read_index] == 0);
+		encode->read_index += 1;
+	}
 
-			encode->state = COBS_ENCODE_STATE_FINAL_ZERO;
-		} else if (encode->u.nozeros.total_length < 254) {
-			*output = encode->u.nozeros.total_length + 1;
+	encode->state = COBS_ENCODE_FLAT_STATE_CODE;
+}
 
-			encode->u.nozeros.data_left = encode->u.nozeros.total_length;
-			encode->state = COBS_ENCODE_STATE_NOZEROS_DATA;
-		} else {
-			*output = 0xFF;
+size_t cobs_encode_flat(struct cobs_encode_flat *encode, uint8_t *output, size_t output_length)
+{
+	size_t num_written = 0;
+
+	while (num_written < output_length) {
+		switch (encode->state) {
+		case COBS_ENCODE_FLAT_STATE_CODE: {
+			const uint8_t *const data = &encode->input[encode->read_index];
+			const size_t max_length = MIN(encode->length - encode->read_index, 254);
+			const uint8_t *const zero = z_cobs_find_zero(data, max_length);
+			const size_t block_length = zero ? (size_t)(zero - data) : max_length;
+
+			encode->code = block_length + 1;
+			encode->data_left = block_length;
+			output[num_written++] = encode->code;
+
+			if (block_length) {
+				encode->state = COBS_ENCODE_FLAT_STATE_DATA;
+			} else {
+				cobs_encode_flat_end_block(encode);
+			}
+			break;
+		}
+
+		case COBS_ENCODE_FLAT_STATE_DATA: {
+			const size_t length = MIN(encode->data_left, output_length - num_written);
+
+			memcpy(&output[num_written], &encode->input[encode->read_index], length);
+			num_written += length;
+			encode->read_index += length;
+			encode->data_left -= length;
+
+			if (encode->data_left == 0) {
+				cobs_encode_flat_end_block(encode);
+			}
+			break;
+		}
 
-			encode->u.nozeros.data_left = 254;
-			encode->state = COBS_ENCODE_STATE_NOZEROS_DATA;
+		case COBS_ENCODE_FLAT_STATE_FINAL_ZERO:
+			output[num_written++] = 0x00;
+			encode->state = COBS_ENCODE_FLAT_STATE_FINISHED;
+			break;
+
+		case COBS_ENCODE_FLAT_STATE_FINISHED:
+		default:
+			return num_written;
 		}
-		break;
 	}
 
-	case COBS_ENCODE_STATE_NOZEROS_DATA: {
-		ret = cobs_buf_cursor_read(&encode->cursor, output, 1);
-		__ASSERT_NO_MSG(ret == 0);
-		ARG_UNUSED(ret);
+	return num_written;
+}
 
-		encode->u.nozeros.data_left -= 1;
-		encode->u.nozeros.total_length -= 1;
+/* Write the complete block. Returns the number of bytes written. */
+static size_t cobs_encode_append_flush(struct cobs_encode_append *encode, uint8_t *output,
+				       size_t output_size)
+{
+	size_t num_written = 0;
 
-		if (encode->u.nozeros.total_length == 0) {
-			__ASSERT_NO_MSG(encode->u.nozeros.data_left == 0);
-			encode->state = COBS_ENCODE_STATE_FINAL_ZERO;
-		} else if (encode->u.nozeros.data_left == 0) {
-			encode->state = COBS_ENCODE_STATE_NOZEROS_CODE;
-		}
-		break;
+	if (output_size == 0) {
+		return 0;
 	}
 
-	case COBS_ENCODE_STATE_FINAL_ZERO:
-		*output = 0x00;
-		encode->state = COBS_ENCODE_STATE_FINISHED;
-		break;
+	if (encode->written == 0) {
+		output[num_written++] = encode->code;
+		encode->written = 1;
+	}
 
-	case COBS_ENCODE_STATE_FINISHED:
-		return true;
+	const size_t offset = encode->written - 1;
+	const size_t length = MIN(encode->block_length - offset, output_size - num_written);
+	memcpy(&output[num_written], &encode->block[offset], length);
+	num_written += length;
+	encode->written += length;
+
+	if (encode->written - 1 == encode->block_length) {
+		encode->last_full = encode->code == 0xFF;
+		encode->block_length = 0;
+		encode->code = 0;
+		encode->written = 0;
 	}
 
-	return false;
+	return num_written;
 }
 
-size_t cobs_encode_stream(struct cobs_encode *encode, uint8_t *output, size_t output_length)
+void cobs_encode_append(struct cobs_encode_append *encode, const uint8_t *input, size_t input_size,
+			uint8_t *output, size_t output_size, size_t *num_read, size_t *num_written)
 {
-	size_t i;
+	*num_read = 0;
+	*num_written = 0;
+
+	if (encode->state != COBS_ENCODE_APPEND_STATE_DATA) {
+		return;
+	}
+
+	while (true) {
+		if (encode->code) {
+			const size_t length = cobs_encode_append_flush(encode, output, output_size);
+			output += length;
+			output_size -= length;
+			*num_written += length;
+
+			if (encode->code) {
+				return;
+			}
+		}
+
+		if (input_size == 0) {
+			return;
+		}
+
+		const size_t max_length = MIN((size_t)254 - encode->block_length, input_size);
+		const uint8_t *const zero = z_cobs_find_zero(input, max_length);
+		const size_t length = zero ? (size_t)(zero - input) : max_length;
+		const size_t consumed = zero ? length + 1 : length;
+
+		if (encode->block_length == 0 && (zero || length == 254) && output_size > length) {
+			/* The whole block is within the input, so we don't need to
+			 * buffer it.
+			 */
+			output[0] = length + 1;
+			memcpy(&output[1], input, length);
+			output += length + 1;
+			output_size -= length + 1;
+			*num_written += length + 1;
+			encode->last_full = !zero;
+		} else {
+			memcpy(&encode->block[encode->block_length], input, length);
+			encode->block_length += length;
+
+			if (zero) {
+				encode->code = encode->block_length + 1;
+			} else if (encode->block_length == 254) {
+				encode->code = 0xFF;
+			}
+		}
+
+		input += consumed;
+		input_size -= consumed;
+		*num_read += consumed;
+	}
+}
+
+size_t cobs_encode_append_finish(struct cobs_encode_append *encode, uint8_t *output,
+				 size_t output_size)
+{
+	size_t num_written = 0;
+
+	while (num_written < output_size) {
+		if (encode->code) {
+			num_written += cobs_encode_append_flush(encode, &output[num_written],
+								output_size - num_written);
+			continue;
+		}
+
+		switch (encode->state) {
+		case COBS_ENCODE_APPEND_STATE_DATA:
+			/* A 0xFF-block doesn't need another block behind it. */
+			if (encode->block_length || !encode->last_full) {
+				encode->code = encode->block_length + 1;
+			}
+			encode->state = COBS_ENCODE_APPEND_STATE_FINAL_ZERO;
+			break;
+
+		case COBS_ENCODE_APPEND_STATE_FINAL_ZERO:
+			output[num_written++] = 0x00;
+			encode->state = COBS_ENCODE_APPEND_STATE_FINISHED;
+			break;
 
-	for (i = 0; i < output_length; i += 1) {
-		const bool done = cobs_encode_stream_single(encode, &output[i]);
-		if (done) {
-			return i;
+		case COBS_ENCODE_APPEND_STATE_FINISHED:
+		default:
+			return num_written;
 		}
 	}
 
-	return i;
+	return num_written;
 }
@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <cobs.h>
+#include <cobs/assembler.h>
+
+#define FRAME_SIZE 254
+#define NUM_BLOCKS 4
+
+COBS_FRAME_POOL_DEFINE(test_pool, FRAME_SIZE, NUM_BLOCKS);
+static K_FIFO_DEFINE(test_fifo);
+
+static struct cobs_assembler test_assembler;
+static struct cobs_frame_pool_stats initial_stats;
+
+/* Deterministic contents of frame `index`, with some zero-bytes. */
+static size_t make_frame(uint32_t index, uint8_t *data)
+{
+	const size_t length = (index * 37) % (FRAME_SIZE + 1);
+
+	for (size_t i = 0; i < length; i++) {
+		data[i] = (index + i) % 7 == 0 ? 0x00 : index + i;
+	}
+
+	return length;
+}
+
+/* Encodes frame `index` including its delimiter. */
+static size_t encode_frame(uint32_t index, uint8_t *encoded)
+{
+	uint8_t data[FRAME_SIZE];
+	const size_t length = make_frame(index, data);
+	const size_t encoded_length = cobs_encode(data, length, encoded);
+
+	encoded[encoded_length] = 0x00;
+	return encoded_length + 1;
+}
+
+static void verify_frame(uint32_t index)
+{
+	uint8_t expected[FRAME_SIZE];
+	const size_t expected_length = make_frame(index, expected);
+	struct cobs_frame *const frame = k_fifo_get(&test_fifo, K_NO_WAIT);
+
+	zassert_not_null(frame, "frame %u", index);
+	zassert_equal(frame->length, expected_length, "frame %u", index);
+	zassert_mem_equal(frame->data, expected, expected_length, "frame %u", index);
+
+	cobs_frame_free(frame);
+}
+
+static void verify_stats(uint32_t frames, uint32_t exhausted, uint32_t too_long, uint32_t invalid)
+{
+	struct cobs_frame_pool_stats stats;
+
+	cobs_frame_pool_stats_get(&test_pool, &stats);
+	zassert_equal(stats.frames - initial_stats.frames, frames);
+	zassert_equal(stats.exhausted - initial_stats.exhausted, exhausted);
+	zassert_equal(stats.too_long - initial_stats.too_long, too_long);
+	zassert_equal(stats.invalid - initial_stats.invalid, invalid);
+}
+
+ZTEST(cobs_assembler_test, test_chunks)
+{
+	static uint8_t stream[NUM_BLOCKS * (COBS_MAX_ENCODED_SIZE(FRAME_SIZE) + 1)];
+
+	for (size_t chunk_size = 1; chunk_size <= 300; chunk_size += 13) {
+		size_t length = 0;
+
+		for (uint32_t i = 0; i < NUM_BLOCKS; i++) {
+			length += encode_frame(chunk_size + i, &stream[length]);
+		}
+
+		/* Consume the frames as they are complete, like a consumer
+		 * thread would. There are never more frames than blocks.
+		 */
+		uint32_t next = chunk_size;
+
+		for (size_t offset = 0; offset < length; offset += chunk_size) {
+			const size_t num_frames = cobs_assembler_feed(
+				&test_assembler, &stream[offset], MIN(chunk_size, length - offset));
+
+			for (size_t i = 0; i < num_frames; i++) {
+				verify_frame(next++);
+			}
+		}
+
+		zassert_equal(next, chunk_size + NUM_BLOCKS);
+	}
+
+	zassert_is_null(k_fifo_get(&test_fifo, K_NO_WAIT));
+	verify_stats(24 * NUM_BLOCKS, 0, 0, 0);
+}
+
+ZTEST(cobs_assembler_test, test_exhausted)
+{
+	uint8_t encoded[COBS_MAX_ENCODED_SIZE(FRAME_SIZE) + 1];
+	struct cobs_frame_pool_stats stats;
+
+	for (uint32_t i = 0; i < NUM_BLOCKS + 2; i++) {
+		cobs_assembler_feed(&test_assembler, encoded, encode_frame(i + 1, encoded));
+	}
+
+	verify_stats(NUM_BLOCKS, 2, 0, 0);
+	cobs_frame_pool_stats_get(&test_pool, &stats);
+	zassert_equal(stats.min_free, 0);
+
+	for (uint32_t i = 0; i < NUM_BLOCKS; i++) {
+		verify_frame(i + 1);
+	}
+
+	/* The blocks are recycled. */
+	for (uint32_t i = 0; i < NUM_BLOCKS; i++) {
+		cobs_assembler_feed(&test_assembler, encoded, encode_frame(i + 10, encoded));
+		verify_frame(i + 10);
+	}
+
+	verify_stats(2 * NUM_BLOCKS, 2, 0, 0);
+}
+
+ZTEST(cobs_assembler_test, test_too_long)
+{
+	static uint8_t data[FRAME_SIZE + 1];
+	uint8_t encoded[COBS_MAX_ENCODED_SIZE(FRAME_SIZE + 1) + 1];
+
+	memset(data, 0x11, sizeof(data));
+
+	size_t length = cobs_encode(data, sizeof(data), encoded);
+	encoded[length++] = 0x00;
+
+	cobs_assembler_feed(&test_assembler, encoded, length);
+	zassert_is_null(k_fifo_get(&test_fifo, K_NO_WAIT));
+	verify_stats(0, 0, 1, 0);
+
+	/* A full block ending with a code which doesn't add a zero. */
+	encoded[0] = 0xFF;
+	memset(&encoded[1], 0x22, FRAME_SIZE);
+	encoded[FRAME_SIZE + 1] = 0x01;
+	encoded[FRAME_SIZE + 2] = 0x00;
+
+	zassert_equal(cobs_assembler_feed(&test_assembler, encoded, FRAME_SIZE + 3), 1);
+
+	struct cobs_frame *const frame = k_fifo_get(&test_fifo, K_NO_WAIT);
+
+	zassert_not_null(frame);
+	zassert_equal(frame->length, FRAME_SIZE);
+	zassert_mem_equal(frame->data, &encoded[1], FRAME_SIZE);
+	cobs_frame_free(frame);
+
+	verify_stats(1, 0, 1, 0);
+}
+
+ZTEST(cobs_assembler_test, test_invalid)
+{
+	static const uint8_t stream[] = {0x05, 0x11, 0x22, 0x00, 0x02, 0x33, 0x00};
+
+	zassert_equal(cobs_assembler_feed(&test_assembler, stream, sizeof(stream)), 1);
+
+	struct cobs_frame *const frame = k_fifo_get(&test_fifo, K_NO_WAIT);
+
+	zassert_not_null(frame);
+	zassert_equal(frame->length, 1);
+	zassert_equal(frame->data[0], 0x33);
+	cobs_frame_free(frame);
+
+	verify_stats(1, 0, 0, 1);
+}
+
+ZTEST(cobs_assembler_test, test_delimiters)
+{
+	static const uint8_t stream[] = {0x00, 0x00, 0x01, 0x00, 0x00, 0x02, 0x44, 0x00};
+
+	zassert_equal(cobs_assembler_feed(&test_assembler, stream, sizeof(stream)), 2);
+
+	struct cobs_frame *frame = k_fifo_get(&test_fifo, K_NO_WAIT);
+
+	zassert_not_null(frame);
+	zassert_equal(frame->length, 0);
+	cobs_frame_free(frame);
+
+	frame = k_fifo_get(&test_fifo, K_NO_WAIT);
+	zassert_not_null(frame);
+	zassert_equal(frame->length, 1);
+	zassert_equal(frame->data[0], 0x44);
+	cobs_frame_free(frame);
+
+	verify_stats(2, 0, 0, 0);
+}
+
+ZTEST(cobs_assembler_test, test_reset)
+{
+	uint8_t encoded[COBS_MAX_ENCODED_SIZE(FRAME_SIZE) + 1];
+	const size_t length = encode_frame(5, encoded);
+
+	cobs_assembler_feed(&test_assembler, encoded, length / 2);
+	cobs_assembler_reset(&test_assembler);
+
+	zassert_equal(cobs_assembler_feed(&test_assembler, encoded, length), 1);
+	verify_frame(5);
+	verify_stats(1, 0, 0, 0);
+}
+
+static void before(void *const fixture)
+{
+	cobs_assembler_init(&test_assembler, &test_pool, &test_fifo);
+	cobs_frame_pool_stats_get(&test_pool, &initial_stats);
+}
+
+static void after(void *const fixture)
+{
+	struct cobs_frame *frame;
+
+	cobs_assembler_reset(&test_assembler);
+
+	while ((frame = k_fifo_get(&test_fifo, K_NO_WAIT))) {
+		cobs_frame_free(frame);
+	}
+}
+
+ZTEST_SUITE(cobs_assembler_test, NULL, NULL, before, after, NULL);
@@ -0,0 +1,198 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Cycle counts of the encoders and decoders, measured in ISR context.
+ *
+ * The numbers are only printed, since they depend on the platform. On
+ * native_posix, the cycle counter doesn't advance while code runs, so this
+ * only verifies that all implementations produce the same data there. Build it
+ * for real hardware to get meaningful numbers, once per CONFIG_COBS_PROFILE_*
+ * to compare the profiles.
+ */
+
+#include <string.h>
+#include <zephyr/irq_offload.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <cobs.h>
+#include <cobs/scan.h>
+
+#define FRAME_SIZE 1024
+#define ITERATIONS 10
+
+static uint8_t input[FRAME_SIZE];
+static uint8_t encoded[COBS_MAX_ENCODED_SIZE(FRAME_SIZE) + 1];
+static size_t encoded_length;
+static uint8_t decoded[FRAME_SIZE];
+static uint8_t reencoded[sizeof(encoded)];
+
+struct decode_run {
+	void (*decode)(struct decode_run *run);
+	size_t decoded_length;
+	uint32_t cycles;
+};
+
+static void decode_bulk(struct decode_run *run)
+{
+	/* cobs_decode doesn't take the delimiter. */
+	if (cobs_decode(encoded, encoded_length - 1, decoded, &run->decoded_length)) {
+		run->decoded_length = 0;
+	}
+}
+
+/* Like a UART RX ISR which gets a whole DMA buffer at once. */
+static void decode_stream(struct decode_run *run)
+{
+	struct cobs_decode decode = {0};
+	size_t num_read;
+
+	cobs_decode_stream(&decode, encoded, encoded_length, decoded, sizeof(decoded), &num_read,
+			   &run->decoded_length);
+}
+
+/* Like a UART RX ISR which gets one byte per interrupt. */
+static void decode_stream_single(struct decode_run *run)
+{
+	struct cobs_decode decode = {0};
+	size_t n = 0;
+
+	for (size_t i = 0; i < encoded_length; i++) {
+		bool available;
+
+		cobs_decode_stream_single(&decode, encoded[i], &decoded[n], &available);
+		n += available;
+	}
+
+	run->decoded_length = n;
+}
+
+static void decode_isr_step(struct decode_run *run)
+{
+	struct cobs_decode_isr decode = {0};
+	size_t n = 0;
+
+	for (size_t i = 0; i < encoded_length; i++) {
+		const int ret = cobs_decode_isr_step(&decode, encoded[i]);
+
+		if (ret >= 0) {
+			decoded[n++] = ret;
+		}
+	}
+
+	run->decoded_length = n;
+}
+
+static void encode_bulk(struct decode_run *run)
+{
+	run->decoded_length = cobs_encode(input, sizeof(input), reencoded);
+}
+
+static void run_in_isr(const void *arg)
+{
+	struct decode_run *const run = (struct decode_run *)arg;
+
+	const uint32_t start = k_cycle_get_32();
+	run->decode(run);
+	run->cycles = k_cycle_get_32() - start;
+}
+
+/* Writes the minimum number of cycles of all iterations to `cycles`. */
+static void measure(void (*decode)(struct decode_run *run), uint32_t *const cycles)
+{
+	*cycles = UINT32_MAX;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		struct decode_run run = {
+			.decode = decode,
+		};
+
+		memset(decoded, 0xAB, sizeof(decoded));
+		irq_offload(run_in_isr, &run);
+
+		zassert_equal(run.decoded_length, FRAME_SIZE);
+		zassert_mem_equal(decoded, input, FRAME_SIZE);
+		*cycles = MIN(*cycles, run.cycles);
+	}
+}
+
+static void measure_encode(uint32_t *const cycles)
+{
+	*cycles = UINT32_MAX;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		struct decode_run run = {
+			.decode = encode_bulk,
+		};
+
+		memset(reencoded, 0xAB, sizeof(reencoded));
+		irq_offload(run_in_isr, &run);
+
+		zassert_equal(run.decoded_length, encoded_length - 1);
+		zassert_mem_equal(reencoded, encoded, encoded_length - 1);
+		*cycles = MIN(*cycles, run.cycles);
+	}
+}
+
+static void benchmark_frame(const char *const name)
+{
+	encoded_length = cobs_encode(input, sizeof(input), encoded);
+	encoded[encoded_length++] = 0x00;
+
+	uint32_t encode;
+	uint32_t decode;
+	uint32_t stream;
+	uint32_t stream_single;
+	uint32_t isr_step;
+
+	measure_encode(&encode);
+	measure(decode_bulk, &decode);
+	measure(decode_stream, &stream);
+	measure(decode_stream_single, &stream_single);
+	measure(decode_isr_step, &isr_step);
+
+	TC_PRINT("%s: %zu bytes, cobs_encode: %u cycles, cobs_decode: %u cycles, "
+		 "cobs_decode_stream: %u cycles\n",
+		 name, encoded_length, encode, decode, stream);
+	TC_PRINT("%s: cobs_decode_stream_single: %u cycles, cobs_decode_isr_step: %u cycles\n",
+		 name, stream_single, isr_step);
+}
+
+ZTEST(cobs_benchmark, test_decode_short_blocks)
+{
+	for (size_t i = 0; i < sizeof(input); i++) {
+		input[i] = i % 8 == 7 ? 0 : i + 1;
+	}
+
+	benchmark_frame("short blocks");
+}
+
+ZTEST(cobs_benchmark, test_decode_long_blocks)
+{
+	for (size_t i = 0; i < sizeof(input); i++) {
+		input[i] = i % 255 + 1;
+	}
+
+	benchmark_frame("long blocks");
+}
+
+ZTEST(cobs_benchmark, test_decode_zeros)
+{
+	memset(input, 0, sizeof(input));
+
+	benchmark_frame("zeros");
+}
+
+static void *setup(void)
+{
+#if defined(Z_COBS_ARM_DSP)
+	TC_PRINT("zero-byte search: Arm DSP\n");
+#elif defined(Z_COBS_WORD_SCAN)
+	TC_PRINT("zero-byte search: word-wise\n");
+#else
+	TC_PRINT("zero-byte search: memchr\n");
+#endif
+
+	return NULL;
+}
+
+ZTEST_SUITE(cobs_benchmark, NULL, setup, NULL, NULL, NULL);
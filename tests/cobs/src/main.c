@@ -11,6 +11,11 @@
 #include <zephyr/types.h>
 #include <zephyr/ztest.h>
 #include <cobs.h>
+#include <cobs/batch.h>
+#include <cobs/cut_through.h>
+#include <cobs/fixed.h>
+#include <cobs/ring_buf.h>
+#include <cobs/scan.h>
 #include <cobs/testutils.h>
 
 static void verify_inplace_decoder(const uint8_t *const input_data_, const size_t input_length,
@@ -29,6 +34,49 @@ static void verify_inplace_decoder(const uint8_t *const input_data_, const size_
 	free(input_data);
 }
 
+static void verify_decode_runs(const uint8_t *const input_data, const size_t input_length,
+			       const uint8_t *const reference, const size_t reference_length)
+{
+	struct cobs_decode_runs runs;
+	size_t output_length = 0;
+	const uint8_t *run;
+	size_t run_length;
+	bool followed_by_zero;
+	int ret;
+
+	cobs_decode_runs_init(&runs, input_data, input_length);
+
+	while ((ret = cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero)) == 1) {
+		zassert_true(run >= input_data && run + run_length <= input_data + input_length);
+		zassert_true(output_length + run_length <= reference_length);
+		zassert_mem_equal(run, &reference[output_length], run_length);
+		output_length += run_length;
+
+		if (followed_by_zero) {
+			zassert_true(output_length < reference_length);
+			zassert_equal(reference[output_length], 0x00);
+			output_length += 1;
+		}
+	}
+
+	zassert_equal(ret, 0);
+	zassert_equal(output_length, reference_length);
+}
+
+static void verify_fixed(const uint8_t *const input, const size_t length,
+			 const uint8_t *const encoded, const size_t encoded_length)
+{
+	uint8_t buffer[COBS_FIXED_ENCODED_SIZE(COBS_FIXED_MAX_SIZE)];
+
+	zassert_equal(encoded_length, COBS_FIXED_ENCODED_SIZE(length));
+
+	cobs_encode_fixed(input, length, buffer);
+	zassert_mem_equal(buffer, encoded, encoded_length);
+
+	zassert_ok(cobs_decode_fixed(buffer, length, buffer));
+	zassert_mem_equal(buffer, input, length);
+}
+
 static void roundtrip_test_runner(const void *input, const size_t length)
 {
 	int ret;
@@ -52,6 +100,11 @@ static void roundtrip_test_runner(const void *input, const size_t length)
 	zassert_equal(decoded_buffer[length], 0xAB);
 
 	verify_inplace_decoder(encoded_buffer, encoded_length, decoded_buffer, decoded_length);
+	verify_decode_runs(encoded_buffer, encoded_length, decoded_buffer, decoded_length);
+
+	if (length > 0 && length <= COBS_FIXED_MAX_SIZE) {
+		verify_fixed(input, length, encoded_buffer, encoded_length);
+	}
 
 	uint8_t *const encoded_buffer2 = malloc(encoded_buffer_length);
 	uint8_t *const decoded_buffer2 = malloc(length + 1);
@@ -63,6 +116,27 @@ static void roundtrip_test_runner(const void *input, const size_t length)
 	zassert_equal(encoded_length2, encoded_length + 1);
 	zassert_mem_equal(encoded_buffer2, encoded_buffer, encoded_length);
 
+	static const size_t chunk_sizes[] = {1, 2, 7, 254, 255, SIZE_MAX};
+
+	for (size_t i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		memset(encoded_buffer2, 0xAB, encoded_buffer_length);
+
+		const size_t encoded_length3 = cobs_encode_flat_simple(
+			input, length, encoded_buffer2, encoded_buffer_length, chunk_sizes[i]);
+		zassert_equal(encoded_length3, encoded_length + 1);
+		zassert_mem_equal(encoded_buffer2, encoded_buffer, encoded_length);
+
+		for (size_t j = 0; j < ARRAY_SIZE(chunk_sizes); j++) {
+			memset(encoded_buffer2, 0xAB, encoded_buffer_length);
+
+			const size_t encoded_length4 = cobs_encode_append_simple(
+				input, length, encoded_buffer2, encoded_buffer_length,
+				chunk_sizes[i], chunk_sizes[j]);
+			zassert_equal(encoded_length4, encoded_length + 1);
+			zassert_mem_equal(encoded_buffer2, encoded_buffer, encoded_length);
+		}
+	}
+
 	size_t decoded_length2;
 	ret = cobs_decode_stream_simple(encoded_buffer2, encoded_length2, decoded_buffer2,
 					length + 1, &decoded_length2);
@@ -71,6 +145,14 @@ static void roundtrip_test_runner(const void *input, const size_t length)
 	zassert_mem_equal(decoded_buffer2, input, length);
 	zassert_equal(decoded_buffer2[length], 0xAB);
 
+	memset(decoded_buffer2, 0xAB, length + 1);
+	ret = cobs_decode_isr_simple(encoded_buffer2, encoded_length2, decoded_buffer2, length + 1,
+				     &decoded_length2);
+	zassert_ok(ret);
+	zassert_equal(decoded_length2, length);
+	zassert_mem_equal(decoded_buffer2, input, length);
+	zassert_equal(decoded_buffer2[length], 0xAB);
+
 	/* Just to double-check, compare to the output of the other
 	 * implementation.
 	 */
@@ -249,6 +331,703 @@ ZTEST(lib_cobs_test, test_256_bytes_null_end_rt)
 	roundtrip_test_runner(buffer, sizeof(buffer));
 }
 
+ZTEST(lib_cobs_test, test_decode_isr_invalid)
+{
+	struct cobs_decode_isr decode = {};
+
+	/* Zero within a block */
+	zassert_equal(cobs_decode_isr_step(&decode, 0x03), COBS_DECODE_ISR_NO_OUTPUT);
+	zassert_equal(cobs_decode_isr_step(&decode, 0x11), 0x11);
+	zassert_equal(cobs_decode_isr_step(&decode, 0x00), COBS_DECODE_ISR_UNEXPECTED_ZERO);
+	zassert_equal(cobs_decode_isr_step(&decode, 0x11), COBS_DECODE_ISR_ERROR);
+
+	/* Use after the end of a frame */
+	cobs_decode_isr_reset(&decode);
+	zassert_equal(cobs_decode_isr_step(&decode, 0x01), COBS_DECODE_ISR_NO_OUTPUT);
+	zassert_equal(cobs_decode_isr_step(&decode, 0x00), COBS_DECODE_ISR_FINISHED);
+	zassert_equal(cobs_decode_isr_step(&decode, 0x01), COBS_DECODE_ISR_ERROR);
+	zassert_equal(cobs_decode_isr_step(&decode, 0x00), COBS_DECODE_ISR_ERROR);
+}
+
+static uint32_t test_clock_now;
+
+static uint32_t test_clock(void)
+{
+	return test_clock_now;
+}
+
+static void verify_decode_timed(struct cobs_decode_timed *decode, uint32_t now,
+				const uint8_t *input, size_t input_size, size_t expected_read,
+				enum cobs_decode_result expected_result,
+				struct cobs_decode_timestamps *timestamps)
+{
+	uint8_t output[8];
+	size_t num_read;
+	size_t num_written;
+
+	test_clock_now = now;
+
+	const enum cobs_decode_result result =
+		cobs_decode_stream_timed(decode, input, input_size, output, sizeof(output),
+					 &num_read, &num_written, timestamps);
+
+	zassert_equal(result, expected_result);
+	zassert_equal(num_read, expected_read);
+}
+
+ZTEST(lib_cobs_test, test_decode_stream_timed)
+{
+	static const uint8_t stream[] = {0x03, 0x11, 0x22, 0x02, 0x33, 0x00, 0x02, 0x44, 0x00};
+	struct cobs_decode_timed decode;
+	struct cobs_decode_timestamps timestamps;
+
+	cobs_decode_timed_init(&decode, test_clock);
+
+	/* The first frame is spread over three chunks, the last of which also
+	 * starts the second frame.
+	 */
+	verify_decode_timed(&decode, 5, stream, 0, 0, COBS_DECODE_RESULT_CONSUMED, &timestamps);
+	verify_decode_timed(&decode, 10, &stream[0], 2, 2, COBS_DECODE_RESULT_CONSUMED,
+			    &timestamps);
+	verify_decode_timed(&decode, 20, &stream[2], 2, 2, COBS_DECODE_RESULT_CONSUMED,
+			    &timestamps);
+	verify_decode_timed(&decode, 30, &stream[4], 4, 2, COBS_DECODE_RESULT_FINISHED,
+			    &timestamps);
+	zassert_equal(timestamps.first_byte, 10);
+	zassert_equal(timestamps.delimiter, 30);
+
+	cobs_decode_timed_reset(&decode);
+	verify_decode_timed(&decode, 35, &stream[6], 2, 2, COBS_DECODE_RESULT_CONSUMED,
+			    &timestamps);
+	verify_decode_timed(&decode, 50, &stream[8], 1, 1, COBS_DECODE_RESULT_FINISHED,
+			    &timestamps);
+	zassert_equal(timestamps.first_byte, 35);
+	zassert_equal(timestamps.delimiter, 50);
+}
+
+#define CUT_THROUGH_PREFIX 4
+
+/* Collects the events of a cut-through decoder. */
+struct cut_through_recorder {
+	struct cobs_cut_through cut;
+	uint8_t buffer[16];
+	uint8_t frame[300];
+	size_t length;
+	size_t num_prefix;
+	size_t num_end;
+	size_t num_abort;
+	bool bad_event;
+};
+
+static void cut_through_cb(struct cobs_cut_through *cut, enum cobs_cut_through_event event,
+			   const uint8_t *data, size_t length)
+{
+	struct cut_through_recorder *const recorder =
+		CONTAINER_OF(cut, struct cut_through_recorder, cut);
+
+	if (recorder->length + length > sizeof(recorder->frame)) {
+		recorder->bad_event = true;
+		return;
+	}
+
+	memcpy(&recorder->frame[recorder->length], data, length);
+	recorder->length += length;
+
+	switch (event) {
+	case COBS_CUT_THROUGH_PREFIX:
+		recorder->bad_event |= recorder->length != CUT_THROUGH_PREFIX;
+		recorder->num_prefix++;
+		break;
+	case COBS_CUT_THROUGH_DATA:
+		recorder->bad_event |= recorder->num_prefix != 1 || length == 0;
+		break;
+	case COBS_CUT_THROUGH_END:
+		recorder->num_end++;
+		break;
+	case COBS_CUT_THROUGH_ABORT:
+		recorder->bad_event |= length != 0;
+		recorder->num_abort++;
+		break;
+	}
+}
+
+static void cut_through_recorder_init(struct cut_through_recorder *recorder)
+{
+	memset(recorder, 0, sizeof(*recorder));
+	zassert_ok(cobs_cut_through_init(&recorder->cut, recorder->buffer,
+					 sizeof(recorder->buffer), CUT_THROUGH_PREFIX,
+					 cut_through_cb));
+}
+
+ZTEST(lib_cobs_test, test_cut_through)
+{
+	static const size_t lengths[] = {0, 1, 3, 4, 5, 17, 254, 255, 300};
+	static const size_t chunk_sizes[] = {1, 2, 7, 64, 400};
+	uint8_t data[300];
+	uint8_t encoded[COBS_MAX_ENCODED_SIZE(sizeof(data)) + 3];
+	struct cut_through_recorder recorder;
+
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = i % 11 == 5 ? 0x00 : i;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(lengths); i++) {
+		/* With delimiters in front of and behind the frame. */
+		encoded[0] = 0x00;
+		size_t encoded_length = 1 + cobs_encode(data, lengths[i], &encoded[1]);
+		encoded[encoded_length++] = 0x00;
+		encoded[encoded_length++] = 0x00;
+
+		for (size_t j = 0; j < ARRAY_SIZE(chunk_sizes); j++) {
+			cut_through_recorder_init(&recorder);
+
+			for (size_t offset = 0; offset < encoded_length; offset += chunk_sizes[j]) {
+				cobs_cut_through_feed(&recorder.cut, &encoded[offset],
+						      MIN(chunk_sizes[j], encoded_length - offset));
+			}
+
+			zassert_false(recorder.bad_event, "length %zu", lengths[i]);
+			zassert_equal(recorder.num_prefix, lengths[i] >= CUT_THROUGH_PREFIX);
+			zassert_equal(recorder.num_end, 1);
+			zassert_equal(recorder.num_abort, 0);
+			zassert_equal(recorder.length, lengths[i]);
+			zassert_mem_equal(recorder.frame, data, lengths[i]);
+		}
+	}
+
+	/* The prefix is delivered as soon as it was received. */
+	memset(data, 0x11, sizeof(data));
+	cobs_encode(data, sizeof(data), encoded);
+	cut_through_recorder_init(&recorder);
+
+	cobs_cut_through_feed(&recorder.cut, encoded, CUT_THROUGH_PREFIX);
+	zassert_equal(recorder.num_prefix, 0);
+	cobs_cut_through_feed(&recorder.cut, &encoded[CUT_THROUGH_PREFIX], 1);
+	zassert_equal(recorder.num_prefix, 1);
+	zassert_equal(recorder.length, CUT_THROUGH_PREFIX);
+}
+
+ZTEST(lib_cobs_test, test_cut_through_abort)
+{
+	static const uint8_t invalid[] = {0x08, 0x11, 0x22, 0x33, 0x44, 0x55, 0x00};
+	static const uint8_t partial[] = {0x08, 0x11, 0x22};
+	static const uint8_t valid[] = {0x02, 0x66, 0x00};
+	struct cut_through_recorder recorder;
+	uint8_t buffer[2];
+
+	cut_through_recorder_init(&recorder);
+
+	cobs_cut_through_feed(&recorder.cut, invalid, sizeof(invalid));
+	zassert_equal(recorder.num_prefix, 1);
+	zassert_equal(recorder.num_abort, 1);
+
+	/* Nothing was delivered yet, but the frame was started. */
+	cobs_cut_through_feed(&recorder.cut, partial, sizeof(partial));
+	cobs_cut_through_reset(&recorder.cut);
+	zassert_equal(recorder.num_abort, 2);
+
+	cobs_cut_through_reset(&recorder.cut);
+	zassert_equal(recorder.num_abort, 2);
+
+	recorder.length = 0;
+	cobs_cut_through_feed(&recorder.cut, valid, sizeof(valid));
+	zassert_equal(recorder.num_end, 1);
+	zassert_equal(recorder.length, 1);
+	zassert_equal(recorder.frame[0], 0x66);
+	zassert_false(recorder.bad_event);
+
+	zassert_equal(cobs_cut_through_init(&recorder.cut, buffer, sizeof(buffer),
+					    sizeof(buffer) + 1, cut_through_cb),
+		      -EINVAL);
+}
+
+COBS_FIXED_DEFINE(test_fixed8, 8);
+COBS_FIXED_DEFINE(test_fixed254, 254);
+
+ZTEST(lib_cobs_test, test_fixed)
+{
+	static const uint8_t input[8] = {0x00, 0x11, 0x22, 0x00, 0x00, 0x33, 0x44, 0x55};
+	static const uint8_t expected[] = {0x01, 0x03, 0x11, 0x22, 0x01, 0x04, 0x33, 0x44, 0x55};
+	uint8_t encoded[COBS_FIXED_ENCODED_SIZE(sizeof(input))];
+	uint8_t decoded[sizeof(input)];
+	uint8_t input254[254];
+	uint8_t encoded254[COBS_FIXED_ENCODED_SIZE(sizeof(input254))];
+
+	test_fixed8_encode(input, encoded);
+	zassert_mem_equal(encoded, expected, sizeof(expected));
+	zassert_ok(test_fixed8_decode(encoded, decoded));
+	zassert_mem_equal(decoded, input, sizeof(input));
+
+	memset(input254, 0x11, sizeof(input254));
+	test_fixed254_encode(input254, encoded254);
+	zassert_equal(encoded254[0], 0xFF);
+	zassert_mem_equal(&encoded254[1], input254, sizeof(input254));
+}
+
+ZTEST(lib_cobs_test, test_fixed_invalid)
+{
+	static const uint8_t unexpected_zero[] = {0x03, 0x11, 0x00, 0x01, 0x01,
+						  0x01, 0x01, 0x01, 0x01};
+	static const uint8_t zero_code[] = {0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01};
+	/* The last block would end behind the frame. */
+	static const uint8_t truncated[] = {0x08, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x02};
+	uint8_t decoded[8];
+
+	zassert_equal(test_fixed8_decode(unexpected_zero, decoded), -EINVAL);
+	zassert_equal(test_fixed8_decode(zero_code, decoded), -EINVAL);
+	zassert_equal(test_fixed8_decode(truncated, decoded), -EINVAL);
+}
+
+ZTEST(lib_cobs_test, test_decode_runs_invalid)
+{
+	static const uint8_t unexpected_zero[] = {0x02, 0x11, 0x03, 0x00, 0x22};
+	static const uint8_t truncated[] = {0x02, 0x11, 0x04, 0x22};
+	struct cobs_decode_runs runs;
+	const uint8_t *run;
+	size_t run_length;
+	bool followed_by_zero;
+
+	cobs_decode_runs_init(&runs, unexpected_zero, sizeof(unexpected_zero));
+	zassert_equal(cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero), 1);
+	zassert_equal(run, &unexpected_zero[1]);
+	zassert_equal(run_length, 1);
+	zassert_true(followed_by_zero);
+	zassert_equal(cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero),
+		      -EINVAL);
+
+	cobs_decode_runs_init(&runs, truncated, sizeof(truncated));
+	zassert_equal(cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero), 1);
+	zassert_equal(cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero),
+		      -EINVAL);
+}
+
+/* The zero-scan kernels against memchr for every alignment and length of `data`. */
+static void verify_zero_scan(const uint8_t *data, size_t size)
+{
+	uint8_t output[32 + 8];
+
+	for (size_t offset = 0; offset < 8; offset++) {
+		for (size_t length = 0; offset + length <= size; length++) {
+			const uint8_t *const input = &data[offset];
+			const uint8_t *const expected = memchr(input, 0, length);
+			const size_t expected_length =
+				expected ? (size_t)(expected - input) : length;
+
+			zassert_equal(z_cobs_find_zero(input, length), expected);
+
+			memset(output, 0xA5, sizeof(output));
+			zassert_equal(z_cobs_copy_nonzero(&output[7 - offset], input, length),
+				      expected_length);
+			zassert_mem_equal(&output[7 - offset], input, expected_length);
+			zassert_equal(output[7 - offset + expected_length], 0xA5);
+		}
+	}
+}
+
+/* The word-wise kernels at every zero position, with a second zero-byte in the
+ * same word and with the bytes around them being 0x01, 0x80 or 0xFF, which
+ * break wrong carry and sign handling.
+ */
+ZTEST(lib_cobs_test, test_zero_scan)
+{
+	static const uint8_t fills[] = {0x5A, 0x01, 0x80, 0xFF};
+	uint8_t data[32];
+
+	for (size_t pattern = 0; pattern <= ARRAY_SIZE(fills); pattern++) {
+		for (size_t zero_index = 0; zero_index <= sizeof(data); zero_index++) {
+			/* Distance of the second zero-byte, 0 for none. */
+			for (size_t gap = 0; gap < 4; gap++) {
+				for (size_t i = 0; i < sizeof(data); i++) {
+					data[i] = pattern < ARRAY_SIZE(fills)
+							  ? fills[pattern]
+							  : fills[i % ARRAY_SIZE(fills)];
+				}
+
+				if (zero_index < sizeof(data)) {
+					data[zero_index] = 0x00;
+				}
+
+				if (gap > 0 && zero_index + gap < sizeof(data)) {
+					data[zero_index + gap] = 0x00;
+				}
+
+				verify_zero_scan(data, sizeof(data));
+			}
+		}
+	}
+}
+
+NET_BUF_POOL_FIXED_DEFINE(test_pool, 4, 600, 0, NULL);
+
+ZTEST(lib_cobs_test, test_encode_buf_headroom)
+{
+	static const uint8_t input[] = {0x11, 0x00, 0x22};
+	static const uint8_t expected[] = {0xAA, 0xBB, 0x02, 0x11, 0x02, 0x22, 0x00};
+
+	struct net_buf *const buf = net_buf_alloc_len(&test_pool, 10, K_NO_WAIT);
+	zassert_not_null(buf);
+	net_buf_reserve(buf, 2);
+
+	zassert_equal(cobs_encode_buf(buf, input, sizeof(input), 5), -ENOMEM);
+	zassert_equal(buf->len, 0);
+
+	zassert_ok(cobs_encode_buf(buf, input, sizeof(input), 1));
+	zassert_equal(buf->len, 4);
+	zassert_equal(net_buf_headroom(buf), 2);
+
+	net_buf_push_u8(buf, 0xBB);
+	net_buf_push_u8(buf, 0xAA);
+	net_buf_add_u8(buf, 0x00);
+	zassert_equal(buf->len, sizeof(expected));
+	zassert_mem_equal(buf->data, expected, sizeof(expected));
+
+	net_buf_unref(buf);
+}
+
+ZTEST(lib_cobs_test, test_encode_stream_buf_headroom)
+{
+	uint8_t input[300];
+	uint8_t expected[COBS_MAX_ENCODED_SIZE(sizeof(input)) + 1];
+
+	for (size_t i = 0; i < sizeof(input); i++) {
+		input[i] = i % 100;
+	}
+	const size_t expected_length = cobs_encode(input, sizeof(input), expected);
+	expected[expected_length] = 0x00;
+
+	struct net_buf *const input_buf = net_buf_alloc_len(&test_pool, sizeof(input), K_NO_WAIT);
+	zassert_not_null(input_buf);
+	net_buf_add_mem(input_buf, input, sizeof(input));
+
+	struct net_buf *const buf = net_buf_alloc_len(&test_pool, 600, K_NO_WAIT);
+	zassert_not_null(buf);
+	net_buf_reserve(buf, 4);
+
+	struct cobs_encode encode;
+	cobs_encode_stream_init(&encode, input_buf);
+	net_buf_unref(input_buf);
+
+	zassert_equal(cobs_encode_stream_buf(&encode, buf, net_buf_tailroom(buf)), 0);
+
+	while (cobs_encode_stream_buf(&encode, buf, 1) > 0) {
+	}
+
+	cobs_encode_stream_free(&encode);
+
+	zassert_equal(buf->len, expected_length + 1);
+	zassert_equal(net_buf_headroom(buf), 4);
+	zassert_mem_equal(buf->data, expected, expected_length + 1);
+
+	net_buf_push_u8(buf, 0xAA);
+	net_buf_add_u8(buf, 0xBB);
+
+	net_buf_unref(buf);
+}
+
+static size_t encode_stream_all(struct cobs_encode *const encode, uint8_t *const output,
+				const size_t output_length, const size_t chunk_size)
+{
+	size_t num_written = 0;
+	size_t nbytes;
+
+	while ((nbytes = cobs_encode_stream(encode, &output[num_written],
+					    MIN(chunk_size, output_length - num_written))) > 0) {
+		num_written += nbytes;
+	}
+
+	cobs_encode_stream_free(encode);
+	return num_written;
+}
+
+ZTEST(lib_cobs_test, test_encode_stream_fragments)
+{
+	static const size_t fragment_lengths[][3] = {
+		{1, 300, 299},
+		{254, 1, 345},
+		{0, 600, 0},
+		{255, 255, 90},
+	};
+	static const size_t chunk_sizes[] = {1, 7, 255, SIZE_MAX};
+	uint8_t input[600];
+	uint8_t expected[COBS_MAX_ENCODED_SIZE(sizeof(input)) + 1];
+	uint8_t output[sizeof(expected)];
+
+	for (size_t i = 0; i < sizeof(input); i++) {
+		input[i] = (i % 300 == 299) ? 0 : i % 254 + 1;
+	}
+	const size_t expected_length = cobs_encode(input, sizeof(input), expected);
+	expected[expected_length] = 0x00;
+
+	for (size_t i = 0; i < ARRAY_SIZE(fragment_lengths); i++) {
+		struct net_buf *head = NULL;
+		size_t offset = 0;
+
+		for (size_t j = 0; j < ARRAY_SIZE(fragment_lengths[i]); j++) {
+			struct net_buf *const frag = net_buf_alloc_len(&test_pool, 600, K_NO_WAIT);
+			zassert_not_null(frag);
+			net_buf_add_mem(frag, &input[offset], fragment_lengths[i][j]);
+			offset += fragment_lengths[i][j];
+
+			if (head) {
+				net_buf_frag_add(head, frag);
+			} else {
+				head = frag;
+			}
+		}
+		zassert_equal(offset, sizeof(input));
+
+		for (size_t j = 0; j < ARRAY_SIZE(chunk_sizes); j++) {
+			struct cobs_encode encode;
+
+			memset(output, 0xAB, sizeof(output));
+			cobs_encode_stream_init(&encode, head);
+			const size_t num_written =
+				encode_stream_all(&encode, output, sizeof(output), chunk_sizes[j]);
+			zassert_equal(num_written, expected_length + 1);
+			zassert_mem_equal(output, expected, num_written);
+		}
+
+		net_buf_unref(head);
+	}
+}
+
+ZTEST(lib_cobs_test, test_encode_stream_mem_source)
+{
+	static const uint8_t input[] = {0x11, 0x00, 0x22, 0x00};
+	static const uint8_t expected[] = {0x02, 0x11, 0x02, 0x22, 0x01, 0x00};
+	struct cobs_mem_source source;
+	struct cobs_encode encode;
+	uint8_t output[sizeof(expected)];
+
+	cobs_mem_source_init(&source, input, sizeof(input));
+	cobs_encode_stream_init_source(&encode, &source.source);
+
+	const size_t num_written = encode_stream_all(&encode, output, sizeof(output), 2);
+	zassert_equal(num_written, sizeof(expected));
+	zassert_mem_equal(output, expected, sizeof(expected));
+}
+
+ZTEST(lib_cobs_test, test_encode_batch)
+{
+	static const uint8_t data_a[] = {0x11, 0x00, 0x22};
+	static const uint8_t data_c[] = {0x00};
+	uint8_t data_b[254];
+	uint8_t data_d[300];
+	uint8_t expected[640];
+	uint8_t output[sizeof(expected)];
+	size_t frame_ends[4];
+	size_t expected_length = 0;
+
+	memset(data_b, 0x33, sizeof(data_b));
+	for (size_t i = 0; i < sizeof(data_d); i++) {
+		data_d[i] = i % 100;
+	}
+
+	const struct cobs_batch_msg msgs[] = {
+		{data_a, sizeof(data_a)},
+		{data_b, sizeof(data_b)},
+		{data_c, sizeof(data_c)},
+		{data_d, sizeof(data_d)},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(msgs); i++) {
+		expected_length +=
+			cobs_encode(msgs[i].data, msgs[i].length, &expected[expected_length]);
+		expected[expected_length++] = 0x00;
+		frame_ends[i] = expected_length;
+	}
+
+	/* Every size from nothing to all messages, which includes exact fits
+	 * that are smaller than the worst case.
+	 */
+	for (size_t output_size = 0; output_size <= sizeof(output); output_size++) {
+		size_t expected_msgs = 0;
+		size_t num_written;
+
+		while (expected_msgs < ARRAY_SIZE(msgs) &&
+		       frame_ends[expected_msgs] <= output_size) {
+			expected_msgs++;
+		}
+
+		const size_t num_msgs = cobs_encode_batch(msgs, ARRAY_SIZE(msgs), output,
+							  output_size, &num_written);
+		zassert_equal(num_msgs, expected_msgs, "output_size=%zu", output_size);
+		zassert_equal(num_written, expected_msgs ? frame_ends[expected_msgs - 1] : 0);
+		zassert_mem_equal(output, expected, num_written);
+	}
+}
+
+COBS_ENCODE_ZC_POOL_DEFINE(test_zc_pool, 32);
+COBS_ENCODE_ZC_POOL_DEFINE(test_zc_small_pool, 3);
+
+static struct net_buf *alloc_fragments(const uint8_t *input, const size_t *const lengths,
+				       const size_t count)
+{
+	struct net_buf *head = NULL;
+
+	for (size_t i = 0; i < count; i++) {
+		struct net_buf *const frag = net_buf_alloc_len(&test_pool, 600, K_NO_WAIT);
+		if (!frag) {
+			if (head) {
+				net_buf_unref(head);
+			}
+			return NULL;
+		}
+
+		net_buf_add_mem(frag, input, lengths[i]);
+		input += lengths[i];
+
+		if (head) {
+			net_buf_frag_add(head, frag);
+		} else {
+			head = frag;
+		}
+	}
+
+	return head;
+}
+
+ZTEST(lib_cobs_test, test_encode_zc)
+{
+	static const size_t fragment_lengths[] = {254, 1, 345};
+	uint8_t input[600];
+	uint8_t expected[COBS_MAX_ENCODED_SIZE(sizeof(input)) + 1];
+	uint8_t output[sizeof(expected)];
+
+	for (size_t i = 0; i < sizeof(input); i++) {
+		input[i] = (i % 300 == 299 || (i >= 400 && i < 404)) ? 0 : i % 254 + 1;
+	}
+	const size_t expected_length = cobs_encode(input, sizeof(input), expected);
+	expected[expected_length] = 0x00;
+
+	struct net_buf *const head =
+		alloc_fragments(input, fragment_lengths, ARRAY_SIZE(fragment_lengths));
+	zassert_not_null(head);
+
+	struct net_buf *encoded;
+	zassert_ok(cobs_encode_zc(head, &test_zc_pool, K_NO_WAIT, &encoded));
+	zassert_equal(net_buf_frags_len(encoded), expected_length + 1);
+
+	size_t output_length = 0;
+	for (struct net_buf *frag = encoded; frag; frag = frag->frags) {
+		memcpy(&output[output_length], frag->data, frag->len);
+		output_length += frag->len;
+	}
+	zassert_mem_equal(output, expected, expected_length + 1);
+
+	/* The data isn't copied */
+	zassert_equal(encoded->len, 1);
+	zassert_equal_ptr(encoded->frags->data, head->data);
+	zassert_equal(encoded->frags->len, 254);
+
+	net_buf_unref(encoded);
+	zassert_equal(head->ref, 1);
+	net_buf_unref(head);
+}
+
+ZTEST(lib_cobs_test, test_encode_zc_nomem)
+{
+	static const uint8_t input[] = {0x11, 0x00, 0x22, 0x00, 0x33};
+	const size_t length = sizeof(input);
+	struct net_buf *encoded = NULL;
+
+	struct net_buf *const head = alloc_fragments(input, &length, 1);
+	zassert_not_null(head);
+
+	zassert_equal(cobs_encode_zc(head, &test_zc_small_pool, K_NO_WAIT, &encoded), -ENOMEM);
+	zassert_is_null(encoded);
+	zassert_equal(head->ref, 1);
+
+	net_buf_unref(head);
+}
+
+RING_BUF_DECLARE(test_ring, 12);
+
+/* Moves the head of `ring` to `offset`, so the next data wraps around. */
+static void ring_buf_rotate(struct ring_buf *const ring, const uint32_t offset)
+{
+	uint8_t *data;
+
+	ring_buf_reset(ring);
+	zassert_equal(ring_buf_put_claim(ring, &data, offset), offset);
+	zassert_ok(ring_buf_put_finish(ring, offset));
+	zassert_equal(ring_buf_get(ring, NULL, offset), offset);
+}
+
+ZTEST(lib_cobs_test, test_encode_ring_buf)
+{
+	static const uint8_t input[] = {0x11, 0x22, 0x00, 0x33, 0x44, 0x55, 0x66, 0x77,
+					0x00, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE};
+	uint8_t expected[COBS_MAX_ENCODED_SIZE(sizeof(input)) + 1];
+	uint8_t output[sizeof(expected)];
+	struct cobs_mem_source source;
+	struct cobs_encode encode;
+	size_t output_length = 0;
+
+	ring_buf_rotate(&test_ring, 8);
+
+	const size_t expected_length = cobs_encode(input, sizeof(input), expected);
+	expected[expected_length] = 0x00;
+
+	cobs_mem_source_init(&source, input, sizeof(input));
+	cobs_encode_stream_init_source(&encode, &source.source);
+
+	/* Fill the ring, wrapping around its end, and drain it. */
+	for (;;) {
+		const size_t num_written = cobs_encode_ring_buf(&encode, &test_ring);
+		zassert_equal(num_written, ring_buf_size_get(&test_ring));
+		if (num_written == 0) {
+			break;
+		}
+
+		zassert_true(output_length + num_written <= sizeof(output));
+		zassert_equal(ring_buf_get(&test_ring, &output[output_length], num_written),
+			      num_written);
+		output_length += num_written;
+	}
+
+	cobs_encode_stream_free(&encode);
+
+	zassert_equal(output_length, expected_length + 1);
+	zassert_mem_equal(output, expected, output_length);
+}
+
+ZTEST(lib_cobs_test, test_decode_ring_buf)
+{
+	static const uint8_t input[] = {0x03, 0x11, 0x22, 0x04, 0x33, 0x44, 0x55, 0x00, 0x02, 0x66};
+	static const uint8_t expected[] = {0x11, 0x22, 0x00, 0x33, 0x44, 0x55};
+	struct cobs_decode decode = {};
+	uint8_t output[sizeof(expected)];
+	size_t num_written;
+
+	ring_buf_rotate(&test_ring, 8);
+	zassert_equal(ring_buf_put(&test_ring, input, sizeof(input)), sizeof(input));
+
+	/* Too little space stops decoding without consuming the rest. */
+	zassert_equal(cobs_decode_ring_buf(&decode, &test_ring, output, 4, &num_written),
+		      COBS_DECODE_RESULT_CONSUMED);
+	zassert_equal(num_written, 4);
+	zassert_equal(ring_buf_size_get(&test_ring), 5);
+
+	/* The frame wraps around the end of the ring. */
+	zassert_equal(cobs_decode_ring_buf(&decode, &test_ring, &output[4], sizeof(output) - 4,
+					   &num_written),
+		      COBS_DECODE_RESULT_FINISHED);
+	zassert_equal(num_written, 2);
+	zassert_mem_equal(output, expected, sizeof(expected));
+
+	/* The beginning of the next frame stays within the ring. */
+	zassert_equal(ring_buf_size_get(&test_ring), 2);
+
+	cobs_decode_reset(&decode);
+	zassert_equal(
+		cobs_decode_ring_buf(&decode, &test_ring, output, sizeof(output), &num_written),
+		COBS_DECODE_RESULT_CONSUMED);
+	zassert_equal(num_written, 1);
+	zassert_equal(output[0], 0x66);
+	zassert_equal(ring_buf_size_get(&test_ring), 0);
+}
+
 static void before(void *const fixture)
 {
 	ARG_UNUSED(fixture);
@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <cstring>
+#include <zephyr/ztest.h>
+#include <cobs.hpp>
+
+/* Everything in here is evaluated by the compiler. If it builds, it works. */
+constexpr auto encoded_array = cobs::encode(std::array{0x11, 0x00, 0x22});
+static_assert(encoded_array.size() == 4);
+static_assert(encoded_array.status() == 0);
+static_assert(encoded_array.bytes[0] == 0x02);
+static_assert(encoded_array.bytes[1] == 0x11);
+static_assert(encoded_array.bytes[2] == 0x02);
+static_assert(encoded_array.bytes[3] == 0x22);
+static_assert(cobs::encoded_size(std::array{0x11, 0x00, 0x22}) == encoded_array.size());
+
+constexpr auto decoded_array = cobs::decode(std::array{0x02, 0x11, 0x02, 0x22});
+static_assert(decoded_array.status() == 0);
+static_assert(decoded_array.size() == 3);
+static_assert(decoded_array.bytes[0] == 0x11);
+static_assert(decoded_array.bytes[1] == 0x00);
+static_assert(decoded_array.bytes[2] == 0x22);
+
+constexpr auto decoded_invalid = cobs::decode(std::array{0x03, 0x11});
+static_assert(decoded_invalid.status() == -EINVAL);
+static_assert(decoded_invalid.size() == 0);
+
+constexpr auto command = cobs::encode_constant<"AT\r">();
+static_assert(std::is_same_v<decltype(command), const std::array<std::uint8_t, 4>>);
+static_assert(command[0] == 0x04);
+static_assert(command[3] == '\r');
+
+constexpr auto command_frame = cobs::encode_constant<"\x01\x00", true>();
+static_assert(std::is_same_v<decltype(command_frame), const std::array<std::uint8_t, 4>>);
+static_assert(command_frame[0] == 0x02);
+static_assert(command_frame[1] == 0x01);
+static_assert(command_frame[2] == 0x01);
+static_assert(command_frame[3] == 0x00);
+
+constexpr std::array<std::uint8_t, 2> two_zeros{};
+constexpr auto zeros = cobs::encode_constant<two_zeros>();
+static_assert(zeros.size() == 3);
+
+template <std::size_t N> constexpr std::array<std::uint8_t, N> make_pattern(const std::size_t zero)
+{
+	std::array<std::uint8_t, N> data{};
+
+	for (std::size_t i = 0; i < N; i++) {
+		data[i] = i == zero ? 0 : i % 254 + 1;
+	}
+
+	return data;
+}
+
+template <std::size_t N, std::size_t Zero> static void verify_runtime_matches_constexpr(void)
+{
+	static constexpr auto expected = cobs::encode(make_pattern<N>(Zero));
+	static_assert(cobs::encoded_size(make_pattern<N>(Zero)) == expected.size());
+
+	const auto input = make_pattern<N>(Zero);
+	const auto encoded = cobs::encode(input);
+	zassert_ok(encoded.status());
+	zassert_equal(encoded.size(), expected.size());
+	zassert_mem_equal(encoded.data(), expected.data(), expected.size());
+
+	std::array<std::uint8_t, cobs::max_encoded_size(N)> reference{};
+	const std::size_t reference_size = cobs_encode(input.data(), N, reference.data());
+	zassert_equal(encoded.size(), reference_size);
+	zassert_mem_equal(encoded.data(), reference.data(), reference_size);
+
+	std::size_t decoded_size;
+	std::array<std::uint8_t, N> decoded{};
+	zassert_ok(cobs_decode(encoded.data(), encoded.size(), decoded.data(), &decoded_size));
+	zassert_equal(decoded_size, N);
+	zassert_mem_equal(decoded.data(), input.data(), N);
+}
+
+ZTEST(lib_cobs_cpp_test, test_runtime_matches_constexpr)
+{
+	verify_runtime_matches_constexpr<1, 0>();
+	verify_runtime_matches_constexpr<254, 254>();
+	verify_runtime_matches_constexpr<254, 253>();
+	verify_runtime_matches_constexpr<255, 255>();
+	verify_runtime_matches_constexpr<255, 254>();
+	verify_runtime_matches_constexpr<600, 300>();
+}
+
+ZTEST(lib_cobs_cpp_test, test_runtime_decode)
+{
+	const std::array<std::uint8_t, 4> input{0x02, 0x11, 0x02, 0x22};
+
+	const auto decoded = cobs::decode(input);
+	zassert_ok(decoded.status());
+	zassert_equal(decoded.size(), decoded_array.size());
+	zassert_mem_equal(decoded.data(), decoded_array.data(), decoded.size());
+
+	const std::array<std::uint8_t, 2> invalid{0x03, 0x11};
+	const auto decoded_invalid = cobs::decode(invalid);
+	zassert_equal(decoded_invalid.status(), -EINVAL);
+	zassert_equal(decoded_invalid.size(), 0);
+}
+
+ZTEST_SUITE(lib_cobs_cpp_test, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <zephyr/ztest.h>
+#include <cobs/ranges.hpp>
+
+static_assert(std::ranges::forward_range<decltype(std::span<const std::uint8_t>() |
+						   cobs::encoded)>);
+static_assert(std::ranges::input_range<decltype(std::span<const std::uint8_t>() |
+						 cobs::decoded)>);
+
+static std::array<std::uint8_t, 600> input;
+static std::array<std::uint8_t, cobs::max_encoded_size(input.size()) + 1> encoded;
+static std::array<std::uint8_t, cobs::max_encoded_size(input.size())> decoded;
+
+static void verify_views(const std::size_t length)
+{
+	const std::span<const std::uint8_t> data(input.data(), length);
+
+	const std::span<std::uint8_t> reference = cobs::encode(data, encoded);
+	zassert_equal(reference.data(), encoded.data());
+
+	std::size_t i = 0;
+	for (const std::uint8_t byte : data | cobs::encoded) {
+		zassert_true(i < reference.size());
+		zassert_equal(byte, reference[i], "mismatch at %zu", i);
+		i++;
+	}
+	zassert_equal(i, reference.size());
+
+	/* Without a delimiter */
+	auto view = std::span<const std::uint8_t>(reference) | cobs::decoded;
+	auto end = std::ranges::copy(view, decoded.begin()).out;
+	zassert_ok(view.status());
+	zassert_equal(static_cast<std::size_t>(end - decoded.begin()), length);
+	zassert_mem_equal(decoded.data(), data.data(), length);
+
+	/* With a delimiter and data after it */
+	encoded[reference.size()] = 0x00;
+	auto view_delimited =
+		std::span<const std::uint8_t>(encoded.data(), reference.size() + 1) |
+		cobs::decoded;
+	end = std::ranges::copy(view_delimited, decoded.begin()).out;
+	zassert_ok(view_delimited.status());
+	zassert_equal(static_cast<std::size_t>(end - decoded.begin()), length);
+	zassert_mem_equal(decoded.data(), data.data(), length);
+
+	std::span<std::uint8_t> decoded_span;
+	zassert_ok(cobs::decode(reference, decoded, decoded_span));
+	zassert_equal(decoded_span.size(), length);
+	zassert_mem_equal(decoded_span.data(), data.data(), length);
+}
+
+ZTEST(lib_cobs_cpp_test, test_views)
+{
+	static const std::size_t lengths[] = {0, 1, 2, 253, 254, 255, 256, 508, 509, 600};
+
+	for (std::size_t i = 0; i < input.size(); i++) {
+		input[i] = i % 254 + 1;
+	}
+
+	for (const std::size_t length : lengths) {
+		verify_views(length);
+	}
+
+	for (std::size_t i = 0; i < input.size(); i += 7) {
+		input[i] = 0;
+	}
+
+	for (const std::size_t length : lengths) {
+		verify_views(length);
+	}
+
+	input.fill(0);
+
+	for (const std::size_t length : lengths) {
+		verify_views(length);
+	}
+}
+
+ZTEST(lib_cobs_cpp_test, test_decoded_view_invalid)
+{
+	static const std::array<std::uint8_t, 4> unexpected_zero{0x03, 0x11, 0x00, 0x22};
+	static const std::array<std::uint8_t, 2> truncated{0x03, 0x11};
+
+	auto view = unexpected_zero | cobs::decoded;
+	zassert_equal(std::ranges::distance(view.begin(), view.end()), 1);
+	zassert_equal(view.status(), -EINVAL);
+
+	auto view_truncated = truncated | cobs::decoded;
+	zassert_equal(std::ranges::distance(view_truncated.begin(), view_truncated.end()), 1);
+	zassert_equal(view_truncated.status(), -EINVAL);
+
+	std::span<std::uint8_t> decoded_span;
+	zassert_equal(cobs::decode(truncated, decoded, decoded_span), -EINVAL);
+	zassert_equal(cobs::decode(truncated, std::span<std::uint8_t>(), decoded_span),
+		      -ENOBUFS);
+}
@@ -0,0 +1,213 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+#include <cobs.h>
+#include <cobs/log.h>
+
+#define BLOCK_SIZE 256
+#define MAX_RECORD_SIZE 64
+
+static const struct flash_area *fa;
+static struct cobs_log test_log;
+static uint8_t buffer[BLOCK_SIZE];
+
+/* Deterministic contents of record `index`, with some zero-bytes. */
+static size_t make_record(uint32_t index, uint8_t *data)
+{
+	const size_t length = (index * 7) % 40;
+
+	for (size_t i = 0; i < length; i++) {
+		data[i] = (index + i) % 5 == 0 ? 0x00 : index + i;
+	}
+
+	return length;
+}
+
+static void append_records(uint32_t first, uint32_t count)
+{
+	uint8_t data[MAX_RECORD_SIZE];
+
+	for (uint32_t i = first; i < first + count; i++) {
+		const size_t length = make_record(i, data);
+
+		zassert_ok(cobs_log_append(&test_log, data, length), "record %u", i);
+	}
+}
+
+static void verify_record(uint32_t record, uint32_t index)
+{
+	uint8_t expected[MAX_RECORD_SIZE];
+	uint8_t data[MAX_RECORD_SIZE];
+	size_t length;
+
+	const size_t expected_length = make_record(index, expected);
+
+	zassert_ok(cobs_log_read(&test_log, record, data, sizeof(data), &length), "record %u",
+		   record);
+	zassert_equal(length, expected_length, "record %u", record);
+	zassert_mem_equal(data, expected, length, "record %u", record);
+}
+
+static void verify_records(uint32_t first, uint32_t count)
+{
+	for (uint32_t i = first; i < first + count; i++) {
+		verify_record(i, i);
+	}
+}
+
+/* Like a reboot. */
+static void reinit(void)
+{
+	memset(&test_log, 0xAB, sizeof(test_log));
+	zassert_ok(cobs_log_init(&test_log, fa, buffer, sizeof(buffer)));
+}
+
+/* Write the first bytes of a frame without a delimiter, as if the power was
+ * lost while appending it.
+ */
+static void write_interrupted(size_t block, size_t offset)
+{
+	static const uint8_t partial[] = {0x10, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+
+	zassert_ok(flash_area_write(fa, block * BLOCK_SIZE + offset, partial, sizeof(partial)));
+}
+
+ZTEST(cobs_log_test, test_append_read)
+{
+	append_records(0, 300);
+	zassert_equal(cobs_log_count(&test_log), 300);
+	verify_records(0, 300);
+
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), 300);
+	verify_records(0, 300);
+
+	append_records(300, 50);
+	zassert_equal(cobs_log_count(&test_log), 350);
+	verify_records(0, 350);
+
+	uint8_t data[MAX_RECORD_SIZE];
+	size_t length;
+
+	zassert_equal(cobs_log_read(&test_log, 350, data, sizeof(data), &length), -ENOENT);
+}
+
+ZTEST(cobs_log_test, test_empty)
+{
+	uint8_t data[MAX_RECORD_SIZE];
+	size_t length;
+
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), 0);
+	zassert_equal(cobs_log_read(&test_log, 0, data, sizeof(data), &length), -ENOENT);
+
+	zassert_ok(cobs_log_append(&test_log, NULL, 0));
+	zassert_ok(cobs_log_read(&test_log, 0, data, sizeof(data), &length));
+	zassert_equal(length, 0);
+
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), 1);
+}
+
+ZTEST(cobs_log_test, test_interrupted_record)
+{
+	append_records(0, 20);
+
+	const size_t block = test_log.block;
+
+	write_interrupted(block, test_log.write_offset);
+
+	/* The partial record is dropped and its block is abandoned. */
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), 20);
+	verify_records(0, 20);
+
+	append_records(20, 30);
+	zassert_true(test_log.block > block);
+
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), 50);
+	verify_records(0, 50);
+}
+
+ZTEST(cobs_log_test, test_interrupted_header)
+{
+	append_records(0, 20);
+	write_interrupted(test_log.block + 1, 0);
+
+	/* The block with the partial header is skipped. */
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), 20);
+
+	append_records(20, 30);
+	zassert_equal(cobs_log_count(&test_log), 50);
+	verify_records(0, 50);
+
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), 50);
+	verify_records(0, 50);
+}
+
+ZTEST(cobs_log_test, test_full)
+{
+	uint8_t data[MAX_RECORD_SIZE];
+	uint32_t count = 0;
+	int ret;
+
+	for (;;) {
+		const size_t length = make_record(count, data);
+
+		ret = cobs_log_append(&test_log, data, length);
+		if (ret) {
+			break;
+		}
+
+		count++;
+	}
+
+	zassert_equal(ret, -ENOSPC);
+	zassert_equal(cobs_log_count(&test_log), count);
+	verify_records(0, count);
+
+	reinit();
+	zassert_equal(cobs_log_count(&test_log), count);
+	verify_records(0, count);
+
+	zassert_ok(cobs_log_clear(&test_log));
+	zassert_equal(cobs_log_count(&test_log), 0);
+	append_records(0, 10);
+	verify_records(0, 10);
+}
+
+ZTEST(cobs_log_test, test_record_size)
+{
+	static uint8_t large[BLOCK_SIZE];
+	uint8_t data[4];
+	size_t length;
+
+	zassert_equal(cobs_log_append(&test_log, large, sizeof(large)), -EMSGSIZE);
+
+	memset(large, 0x11, sizeof(large));
+	zassert_ok(cobs_log_append(&test_log, large, 200));
+	zassert_equal(cobs_log_read(&test_log, 0, data, sizeof(data), &length), -ENOMEM);
+	zassert_equal(length, 200);
+}
+
+static void before(void *const fixture)
+{
+	zassert_ok(flash_area_open(FIXED_PARTITION_ID(storage_partition), &fa));
+	zassert_true(fa->fa_size >= 32 * BLOCK_SIZE);
+
+	zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+	zassert_ok(cobs_log_init(&test_log, fa, buffer, sizeof(buffer)));
+}
+
+static void after(void *const fixture)
+{
+	flash_area_close(fa);
+}
+
+ZTEST_SUITE(cobs_log_test, NULL, NULL, before, after, NULL);
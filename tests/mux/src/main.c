@@ -0,0 +1,205 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/net/buf.h>
+#include <zephyr/ztest.h>
+#include <cobs.h>
+#include <cobs/mux.h>
+
+#define FRAGMENT_SIZE 16
+#define NUM_CHANNELS 3
+#define MAX_MESSAGE_SIZE 1000
+
+/* Channel 0 is for short control messages and channel 2 for bulk data. */
+#define CONTROL 0
+#define BULK 2
+
+NET_BUF_POOL_FIXED_DEFINE(test_pool, 16, MAX_MESSAGE_SIZE, 0, NULL);
+
+static struct cobs_mux_channel tx_channels[NUM_CHANNELS];
+static struct cobs_mux test_mux;
+
+static uint8_t control_buffer[32];
+static uint8_t log_buffer[128];
+static uint8_t bulk_buffer[MAX_MESSAGE_SIZE];
+static struct cobs_demux_channel rx_channels[NUM_CHANNELS] = {
+	COBS_DEMUX_CHANNEL(control_buffer),
+	COBS_DEMUX_CHANNEL(log_buffer),
+	COBS_DEMUX_CHANNEL(bulk_buffer),
+};
+static struct cobs_demux test_demux;
+
+static struct {
+	uint16_t next_seq[NUM_CHANNELS];
+	uint32_t num_messages;
+	bool bad_message;
+	/* Number of bytes on the link when the last message was received. */
+	size_t link_offset;
+	size_t received_at[NUM_CHANNELS];
+} receiver;
+
+/* Message `seq` of `channel`, starting with its number. */
+static size_t make_message(uint8_t channel, uint16_t seq, size_t length, uint8_t *data)
+{
+	for (size_t i = 0; i < length; i++) {
+		data[i] = (seq + i) % 6 == 0 ? 0x00 : channel + seq + i;
+	}
+
+	if (length > 0) {
+		data[0] = seq;
+	}
+
+	return length;
+}
+
+static void send_message(uint8_t channel, uint16_t seq, size_t length)
+{
+	uint8_t data[MAX_MESSAGE_SIZE];
+	struct net_buf *const buf = net_buf_alloc(&test_pool, K_NO_WAIT);
+
+	zassert_not_null(buf);
+	net_buf_add_mem(buf, data, make_message(channel, seq, length, data));
+	zassert_ok(cobs_mux_send(&test_mux, channel, buf));
+}
+
+static void receive_cb(struct cobs_demux *demux, uint8_t channel, const uint8_t *data,
+		       size_t length)
+{
+	uint8_t expected[MAX_MESSAGE_SIZE];
+	const uint16_t seq = receiver.next_seq[channel]++;
+
+	receiver.num_messages++;
+	receiver.received_at[channel] = receiver.link_offset;
+
+	if (length > 0 && data[0] != (uint8_t)seq) {
+		receiver.bad_message = true;
+		return;
+	}
+
+	make_message(channel, seq, length, expected);
+	receiver.bad_message |= memcmp(data, expected, length) != 0;
+}
+
+/* Passes up to `max_length` bytes from the multiplexer to the
+ * demultiplexer, in chunks of `chunk_size`. Returns the number of bytes.
+ */
+static size_t transfer(size_t chunk_size, size_t max_length)
+{
+	uint8_t chunk[64];
+	size_t num_transferred = 0;
+
+	chunk_size = MIN(chunk_size, sizeof(chunk));
+
+	while (num_transferred < max_length) {
+		const size_t length = cobs_mux_encode(&test_mux, chunk,
+						      MIN(chunk_size, max_length - num_transferred));
+		if (length == 0) {
+			break;
+		}
+
+		receiver.link_offset += length;
+		cobs_demux_feed(&test_demux, chunk, length);
+		num_transferred += length;
+	}
+
+	return num_transferred;
+}
+
+ZTEST(cobs_mux_test, test_roundtrip)
+{
+	static const size_t chunk_sizes[] = {1, 5, 64};
+	static const size_t lengths[NUM_CHANNELS][4] = {
+		{0, 1, 16, 32},
+		{15, 17, 100, 128},
+		{0, 33, 254, MAX_MESSAGE_SIZE},
+	};
+	uint16_t seq = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(lengths[0]); j++) {
+			for (uint8_t channel = 0; channel < NUM_CHANNELS; channel++) {
+				send_message(channel, seq, lengths[channel][j]);
+			}
+			seq++;
+		}
+
+		transfer(chunk_sizes[i], SIZE_MAX);
+
+		zassert_false(receiver.bad_message);
+		zassert_equal(receiver.num_messages, NUM_CHANNELS * seq);
+	}
+
+	zassert_equal(cobs_mux_encode(&test_mux, NULL, 0), 0);
+}
+
+ZTEST(cobs_mux_test, test_priority)
+{
+	send_message(BULK, 0, MAX_MESSAGE_SIZE);
+	transfer(64, 10);
+
+	/* The control message only waits for the current sub-frame. */
+	const size_t sent_at = receiver.link_offset;
+
+	send_message(CONTROL, 0, 8);
+	transfer(1, 2 * COBS_MUX_MAX_ENCODED_SIZE(FRAGMENT_SIZE));
+
+	zassert_equal(receiver.next_seq[CONTROL], 1);
+	zassert_equal(receiver.next_seq[BULK], 0);
+	zassert_true(receiver.received_at[CONTROL] - sent_at <=
+		     COBS_MUX_MAX_ENCODED_SIZE(FRAGMENT_SIZE) + COBS_MUX_MAX_ENCODED_SIZE(8));
+
+	transfer(64, SIZE_MAX);
+	zassert_equal(receiver.next_seq[BULK], 1);
+	zassert_false(receiver.bad_message);
+}
+
+ZTEST(cobs_mux_test, test_dropped)
+{
+	static uint8_t stream[4 * COBS_MUX_MAX_ENCODED_SIZE(FRAGMENT_SIZE)];
+	size_t length = 0;
+	size_t length_written;
+
+	/* A message of three sub-frames whose second one is lost. */
+	send_message(BULK, 0, 3 * FRAGMENT_SIZE);
+	while ((length_written = cobs_mux_encode(&test_mux, &stream[length], 1)) > 0) {
+		length += length_written;
+	}
+
+	const uint8_t *const first_end = memchr(stream, 0, length);
+	const uint8_t *const second_end = memchr(first_end + 1, 0, &stream[length] - first_end - 1);
+	const size_t first_length = first_end + 1 - stream;
+	const size_t second_length = second_end - first_end;
+
+	cobs_demux_feed(&test_demux, stream, first_length);
+	cobs_demux_feed(&test_demux, second_end + 1, length - first_length - second_length);
+	zassert_equal(receiver.num_messages, 0);
+
+	/* A message which doesn't fit into the buffer of its channel. */
+	send_message(CONTROL, 0, sizeof(control_buffer) + 1);
+	transfer(64, SIZE_MAX);
+	zassert_equal(receiver.num_messages, 0);
+
+	/* A sub-frame of an unknown channel. */
+	static const uint8_t unknown[] = {
+		0x04, NUM_CHANNELS, Z_COBS_MUX_FIRST | Z_COBS_MUX_LAST, 0x11, 0x00,
+	};
+
+	cobs_demux_feed(&test_demux, unknown, sizeof(unknown));
+	zassert_equal(receiver.num_messages, 0);
+
+	send_message(BULK, 0, 3 * FRAGMENT_SIZE);
+	send_message(CONTROL, 0, sizeof(control_buffer));
+	transfer(64, SIZE_MAX);
+	zassert_equal(receiver.num_messages, 2);
+	zassert_false(receiver.bad_message);
+}
+
+static void before(void *const fixture)
+{
+	zassert_ok(cobs_mux_init(&test_mux, tx_channels, NUM_CHANNELS, FRAGMENT_SIZE));
+	cobs_demux_init(&test_demux, rx_channels, NUM_CHANNELS, receive_cb);
+	memset(&receiver, 0, sizeof(receiver));
+}
+
+ZTEST_SUITE(cobs_mux_test, NULL, NULL, before, NULL, NULL);
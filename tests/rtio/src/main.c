@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/ztest.h>
+#include <cobs.h>
+#include <cobs/rtio.h>
+
+#define MAX_DATA_SIZE 600
+
+RTIO_DEFINE(test_rtio, 4, 4);
+COBS_RTIO_ENCODER_DEFINE(test_encoder, MAX_DATA_SIZE);
+
+/* Stands in for a UART, records everything which is written. */
+static struct {
+	uint8_t data[COBS_RTIO_ENCODED_SIZE(MAX_DATA_SIZE)];
+	size_t length;
+} uart;
+
+static void uart_submit(struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *const sqe = &iodev_sqe->sqe;
+
+	zassert_equal(sqe->op, RTIO_OP_TX);
+	zassert_true(uart.length + sqe->buf_len <= sizeof(uart.data));
+
+	memcpy(&uart.data[uart.length], sqe->buf, sqe->buf_len);
+	uart.length += sqe->buf_len;
+	rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+static const struct rtio_iodev_api uart_api = {
+	.submit = uart_submit,
+};
+
+RTIO_IODEV_DEFINE(uart_iodev, &uart_api, NULL);
+
+static void verify_cqe(int expected_result, void *expected_userdata)
+{
+	struct rtio_cqe *const cqe = rtio_cqe_consume(&test_rtio);
+
+	zassert_not_null(cqe);
+	zassert_equal(cqe->result, expected_result);
+	zassert_equal(cqe->userdata, expected_userdata);
+	rtio_cqe_release(&test_rtio, cqe);
+}
+
+ZTEST(cobs_rtio_test, test_pipeline)
+{
+	static const size_t lengths[] = {0, 1, 253, 254, 255, MAX_DATA_SIZE};
+	static uint8_t data[MAX_DATA_SIZE];
+	static uint8_t decoded[sizeof(uart.data)];
+
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = i % 9 == 0 ? 0x00 : i;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(lengths); i++) {
+		const size_t length = lengths[i];
+		struct rtio_sqe *sqe;
+
+		/* Encode, write the frame and decode what was written, all in
+		 * one chain.
+		 */
+		uart.length = 0;
+
+		sqe = rtio_sqe_acquire(&test_rtio);
+		cobs_rtio_prep_encode(sqe, &test_encoder, 0, data, length, (void *)1);
+		sqe->flags |= RTIO_SQE_CHAINED;
+
+		sqe = rtio_sqe_acquire(&test_rtio);
+		cobs_rtio_prep_write_frame(sqe, &uart_iodev, 0, &test_encoder, (void *)2);
+		sqe->flags |= RTIO_SQE_CHAINED;
+
+		sqe = rtio_sqe_acquire(&test_rtio);
+		cobs_rtio_prep_decode(sqe, 0, uart.data, COBS_RTIO_ENCODED_SIZE(length), decoded,
+				      (void *)3);
+
+		zassert_ok(rtio_submit(&test_rtio, 3));
+
+		uint8_t expected[COBS_RTIO_ENCODED_SIZE(MAX_DATA_SIZE)];
+		size_t frame_length = cobs_encode(data, length, expected);
+
+		expected[frame_length++] = 0x00;
+
+		/* Only the frame is written, without any padding. */
+		verify_cqe(frame_length, (void *)1);
+		verify_cqe(0, (void *)2);
+		verify_cqe(length, (void *)3);
+
+		zassert_equal(uart.length, frame_length);
+		zassert_mem_equal(uart.data, expected, frame_length);
+		zassert_mem_equal(decoded, data, length);
+	}
+}
+
+ZTEST(cobs_rtio_test, test_encode_too_long)
+{
+	static const uint8_t data[MAX_DATA_SIZE + 1];
+	struct rtio_sqe *sqe;
+
+	sqe = rtio_sqe_acquire(&test_rtio);
+	cobs_rtio_prep_encode(sqe, &test_encoder, 0, data, sizeof(data), (void *)1);
+	sqe->flags |= RTIO_SQE_CHAINED;
+
+	sqe = rtio_sqe_acquire(&test_rtio);
+	cobs_rtio_prep_write_frame(sqe, &uart_iodev, 0, &test_encoder, (void *)2);
+
+	zassert_ok(rtio_submit(&test_rtio, 2));
+
+	verify_cqe(-EMSGSIZE, (void *)1);
+	verify_cqe(-ECANCELED, (void *)2);
+	zassert_equal(uart.length, 0);
+}
+
+ZTEST(cobs_rtio_test, test_decode_invalid)
+{
+	static const uint8_t invalid[] = {0x00, 0x03, 0x11, 0x00};
+	static const uint8_t empty[] = {0x00, 0x00};
+	uint8_t decoded[sizeof(invalid)];
+	struct rtio_sqe *sqe;
+
+	/* The rest of the chain is canceled. */
+	sqe = rtio_sqe_acquire(&test_rtio);
+	cobs_rtio_prep_decode(sqe, 0, invalid, sizeof(invalid), decoded, (void *)1);
+	sqe->flags |= RTIO_SQE_CHAINED;
+
+	sqe = rtio_sqe_acquire(&test_rtio);
+	rtio_sqe_prep_write(sqe, &uart_iodev, 0, decoded, sizeof(decoded), (void *)2);
+
+	sqe = rtio_sqe_acquire(&test_rtio);
+	cobs_rtio_prep_decode(sqe, 0, empty, sizeof(empty), decoded, (void *)3);
+
+	zassert_ok(rtio_submit(&test_rtio, 3));
+
+	verify_cqe(-EINVAL, (void *)1);
+	verify_cqe(-ECANCELED, (void *)2);
+	verify_cqe(-EINVAL, (void *)3);
+	zassert_equal(uart.length, 0);
+}
+
+static void before(void *const fixture)
+{
+	uart.length = 0;
+}
+
+ZTEST_SUITE(cobs_rtio_test, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,377 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+#include <cobs.h>
+#include <cobs/tx_queue.h>
+
+#define NUM_PRODUCERS 4
+#define NUM_MESSAGES 500
+#define NUM_WAKEUP_MESSAGES 100
+#define MAX_MESSAGE_SIZE 64
+#define STACK_SIZE 1024
+
+/* The timer of test_wakeup submits messages as an additional producer. */
+#define ISR_PRODUCER NUM_PRODUCERS
+#define NUM_SOURCES (NUM_PRODUCERS + 1)
+
+NET_BUF_POOL_FIXED_DEFINE(test_pool, 16, MAX_MESSAGE_SIZE, 0, NULL);
+NET_BUF_POOL_FIXED_DEFINE(wakeup_pool, NUM_PRODUCERS * NUM_WAKEUP_MESSAGES, MAX_MESSAGE_SIZE,
+			  0, NULL);
+NET_BUF_POOL_FIXED_DEFINE(isr_pool, 4, MAX_MESSAGE_SIZE, 0, NULL);
+
+static K_THREAD_STACK_ARRAY_DEFINE(producer_stacks, NUM_PRODUCERS, STACK_SIZE);
+static struct k_thread producer_threads[NUM_PRODUCERS];
+static K_THREAD_STACK_DEFINE(consumer_stack, STACK_SIZE);
+static struct k_thread consumer_thread;
+
+static struct cobs_tx_queue test_queue;
+
+/* Decodes the output of the queue. */
+static struct {
+	struct cobs_decode decode;
+	uint8_t frame[MAX_MESSAGE_SIZE];
+	size_t length;
+	uint16_t next_seq[NUM_SOURCES];
+	uint32_t num_messages;
+} receiver;
+
+/* A UART whose TX interrupt is emulated by the consumer thread of
+ * test_wakeup, which only runs while the interrupt is enabled.
+ */
+static struct {
+	atomic_t irq_enabled;
+	struct k_sem irq_sem;
+	struct k_sem start_sem;
+	atomic_t done;
+	uint8_t output[NUM_SOURCES * NUM_WAKEUP_MESSAGES *
+		       (COBS_MAX_ENCODED_SIZE(MAX_MESSAGE_SIZE) + 1)];
+	atomic_t length;
+	uint16_t isr_seq;
+	struct net_buf *messages[NUM_PRODUCERS][NUM_WAKEUP_MESSAGES];
+	uint32_t max_submit_cycles[NUM_PRODUCERS];
+} uart;
+
+/* Message `seq` of `producer`, starting with both of them. */
+static size_t make_message(uint8_t producer, uint16_t seq, uint8_t *data)
+{
+	const size_t length = 3 + (seq * 7 + producer) % (MAX_MESSAGE_SIZE - 3);
+
+	data[0] = producer;
+	sys_put_le16(seq, &data[1]);
+
+	for (size_t i = 3; i < length; i++) {
+		data[i] = (seq + i) % 5 == 0 ? 0x00 : seq + i;
+	}
+
+	return length;
+}
+
+static void add_message(struct net_buf *buf, uint8_t producer, uint16_t seq)
+{
+	uint8_t data[MAX_MESSAGE_SIZE];
+
+	net_buf_add_mem(buf, data, make_message(producer, seq, data));
+}
+
+static struct net_buf *alloc_message(uint8_t producer, uint16_t seq)
+{
+	struct net_buf *const buf = net_buf_alloc(&test_pool, K_FOREVER);
+
+	add_message(buf, producer, seq);
+	return buf;
+}
+
+/* Every producer's messages have to arrive complete and in order. */
+static void verify_message(void)
+{
+	uint8_t expected[MAX_MESSAGE_SIZE];
+
+	zassert_true(receiver.length >= 3);
+
+	const uint8_t producer = receiver.frame[0];
+	const uint16_t seq = sys_get_le16(&receiver.frame[1]);
+
+	zassert_true(producer < NUM_SOURCES);
+	zassert_equal(seq, receiver.next_seq[producer], "producer %u", producer);
+
+	const size_t expected_length = make_message(producer, seq, expected);
+
+	zassert_equal(receiver.length, expected_length);
+	zassert_mem_equal(receiver.frame, expected, expected_length);
+
+	receiver.next_seq[producer]++;
+	receiver.num_messages++;
+}
+
+static void receive(const uint8_t *data, size_t length)
+{
+	while (length > 0) {
+		size_t num_read;
+		size_t num_written;
+
+		const enum cobs_decode_result result = cobs_decode_stream(
+			&receiver.decode, data, length, &receiver.frame[receiver.length],
+			sizeof(receiver.frame) - receiver.length, &num_read, &num_written);
+
+		zassert_true(num_read > 0);
+		data += num_read;
+		length -= num_read;
+		receiver.length += num_written;
+
+		if (result == COBS_DECODE_RESULT_FINISHED) {
+			verify_message();
+			cobs_decode_reset(&receiver.decode);
+			receiver.length = 0;
+		} else {
+			zassert_equal(result, COBS_DECODE_RESULT_CONSUMED);
+		}
+	}
+}
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	const uint8_t id = POINTER_TO_UINT(p1);
+
+	for (uint16_t seq = 0; seq < NUM_MESSAGES; seq++) {
+		cobs_tx_queue_submit(&test_queue, alloc_message(id, seq));
+
+		if (seq % 3 == id % 3) {
+			k_yield();
+		}
+	}
+}
+
+static void receive_all(void)
+{
+	uint8_t byte;
+
+	while (cobs_tx_queue_encode(&test_queue, &byte, 1)) {
+		receive(&byte, 1);
+	}
+}
+
+ZTEST(cobs_tx_queue_test, test_order)
+{
+	uint8_t byte;
+
+	/* The consumer starts out stopped and stays so if it's called. */
+	zassert_equal(cobs_tx_queue_encode(&test_queue, &byte, 1), 0);
+	zassert_true(cobs_tx_queue_stop(&test_queue));
+
+	zassert_true(cobs_tx_queue_submit(&test_queue, alloc_message(0, 0)));
+	zassert_false(cobs_tx_queue_submit(&test_queue, alloc_message(0, 1)));
+	zassert_false(cobs_tx_queue_submit(&test_queue, alloc_message(1, 0)));
+
+	/* A message submitted while the previous ones are being encoded. */
+	zassert_equal(cobs_tx_queue_encode(&test_queue, &byte, 1), 1);
+	receive(&byte, 1);
+	zassert_false(cobs_tx_queue_submit(&test_queue, alloc_message(0, 2)));
+	receive_all();
+
+	/* The queue is empty, but the consumer still runs until it stops. A
+	 * message submitted in between makes stopping fail.
+	 */
+	zassert_false(cobs_tx_queue_submit(&test_queue, alloc_message(1, 1)));
+	zassert_false(cobs_tx_queue_stop(&test_queue));
+	receive_all();
+	zassert_true(cobs_tx_queue_stop(&test_queue));
+
+	zassert_true(cobs_tx_queue_submit(&test_queue, alloc_message(1, 2)));
+	receive_all();
+
+	zassert_equal(receiver.num_messages, 6);
+	zassert_equal(receiver.next_seq[0], 3);
+	zassert_equal(receiver.next_seq[1], 3);
+	zassert_equal(receiver.length, 0);
+}
+
+ZTEST(cobs_tx_queue_test, test_producers)
+{
+	const int priority = k_thread_priority_get(k_current_get());
+	uint8_t chunk[16];
+
+	for (size_t i = 0; i < NUM_PRODUCERS; i++) {
+		k_thread_create(&producer_threads[i], producer_stacks[i],
+				K_THREAD_STACK_SIZEOF(producer_stacks[i]), producer, UINT_TO_POINTER(i),
+				NULL, NULL, priority, 0, K_NO_WAIT);
+	}
+
+	while (receiver.num_messages < NUM_PRODUCERS * NUM_MESSAGES) {
+		const size_t length = cobs_tx_queue_encode(&test_queue, chunk, sizeof(chunk));
+
+		receive(chunk, length);
+		k_yield();
+	}
+
+	for (size_t i = 0; i < NUM_PRODUCERS; i++) {
+		zassert_ok(k_thread_join(&producer_threads[i], K_FOREVER));
+		zassert_equal(receiver.next_seq[i], NUM_MESSAGES);
+	}
+
+	zassert_equal(cobs_tx_queue_encode(&test_queue, chunk, sizeof(chunk)), 0);
+	zassert_equal(receiver.length, 0);
+}
+
+static void uart_irq_tx_enable(void)
+{
+	atomic_set(&uart.irq_enabled, 1);
+	k_sem_give(&uart.irq_sem);
+}
+
+static void uart_submit(struct net_buf *buf)
+{
+	if (cobs_tx_queue_submit(&test_queue, buf)) {
+		uart_irq_tx_enable();
+	}
+}
+
+static void wakeup_producer(void *p1, void *p2, void *p3)
+{
+	const uint8_t id = POINTER_TO_UINT(p1);
+
+	/* Start all at once and only submit, so producers run into each
+	 * other as often as possible.
+	 */
+	k_sem_take(&uart.start_sem, K_FOREVER);
+
+	for (uint16_t seq = 0; seq < NUM_WAKEUP_MESSAGES; seq++) {
+		const uint32_t start = k_cycle_get_32();
+
+		uart_submit(uart.messages[id][seq]);
+
+		uart.max_submit_cycles[id] =
+			MAX(uart.max_submit_cycles[id], k_cycle_get_32() - start);
+	}
+}
+
+static void isr_producer(struct k_timer *timer)
+{
+	if (uart.isr_seq == NUM_WAKEUP_MESSAGES) {
+		return;
+	}
+
+	struct net_buf *const buf = net_buf_alloc(&isr_pool, K_NO_WAIT);
+	if (!buf) {
+		return;
+	}
+
+	add_message(buf, ISR_PRODUCER, uart.isr_seq++);
+	uart_submit(buf);
+}
+
+static K_TIMER_DEFINE(isr_timer, isr_producer, NULL);
+
+/* Like the TX interrupt of the README, with a FIFO of 16 bytes. */
+static void consumer(void *p1, void *p2, void *p3)
+{
+	while (!atomic_get(&uart.done)) {
+		if (!atomic_get(&uart.irq_enabled)) {
+			k_sem_take(&uart.irq_sem, K_MSEC(10));
+			continue;
+		}
+
+		const size_t offset = atomic_get(&uart.length);
+		const size_t length = cobs_tx_queue_encode(
+			&test_queue, &uart.output[offset], MIN(16, sizeof(uart.output) - offset));
+
+		if (length == 0) {
+			/* Let producers submit right before the interrupt is
+			 * disabled, where a wake-up would be lost without
+			 * cobs_tx_queue_stop.
+			 */
+			k_yield();
+
+			atomic_clear(&uart.irq_enabled);
+			if (!cobs_tx_queue_stop(&test_queue)) {
+				uart_irq_tx_enable();
+			}
+			continue;
+		}
+
+		atomic_add(&uart.length, length);
+	}
+}
+
+/* Producers preempt each other and the consumer at any point, and the timer
+ * interrupts all of them, so the queue is stopped and started while messages
+ * are submitted concurrently. A lost wake-up leaves messages in the queue with
+ * the consumer stopped.
+ */
+ZTEST(cobs_tx_queue_test, test_wakeup)
+{
+	uint8_t data[MAX_MESSAGE_SIZE];
+	uint8_t encoded[COBS_MAX_ENCODED_SIZE(MAX_MESSAGE_SIZE)];
+	size_t expected_length = 0;
+
+	for (uint8_t producer = 0; producer < NUM_SOURCES; producer++) {
+		for (uint16_t seq = 0; seq < NUM_WAKEUP_MESSAGES; seq++) {
+			const size_t length = make_message(producer, seq, data);
+
+			expected_length += cobs_encode(data, length, encoded) + 1;
+
+			if (producer != ISR_PRODUCER) {
+				uart.messages[producer][seq] =
+					net_buf_alloc(&wakeup_pool, K_NO_WAIT);
+				add_message(uart.messages[producer][seq], producer, seq);
+			}
+		}
+	}
+
+	k_sem_init(&uart.irq_sem, 0, K_SEM_MAX_LIMIT);
+	k_sem_init(&uart.start_sem, 0, NUM_PRODUCERS);
+	k_thread_create(&consumer_thread, consumer_stack, K_THREAD_STACK_SIZEOF(consumer_stack),
+			consumer, NULL, NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+
+	for (size_t i = 0; i < NUM_PRODUCERS; i++) {
+		k_thread_create(&producer_threads[i], producer_stacks[i],
+				K_THREAD_STACK_SIZEOF(producer_stacks[i]), wakeup_producer,
+				UINT_TO_POINTER(i), NULL, NULL, K_PRIO_PREEMPT(1), 0, K_NO_WAIT);
+	}
+
+	k_timer_start(&isr_timer, K_TICKS(1), K_TICKS(1));
+
+	for (size_t i = 0; i < NUM_PRODUCERS; i++) {
+		k_sem_give(&uart.start_sem);
+	}
+
+	for (size_t i = 0; i < NUM_PRODUCERS; i++) {
+		zassert_ok(k_thread_join(&producer_threads[i], K_FOREVER));
+	}
+
+	const int64_t deadline = k_uptime_get() + 10 * MSEC_PER_SEC;
+
+	while ((size_t)atomic_get(&uart.length) < expected_length && k_uptime_get() < deadline) {
+		k_sleep(K_MSEC(1));
+	}
+
+	k_timer_stop(&isr_timer);
+	atomic_set(&uart.done, 1);
+	zassert_ok(k_thread_join(&consumer_thread, K_FOREVER));
+
+	zassert_equal((size_t)atomic_get(&uart.length), expected_length, "TX stalled");
+	receive(uart.output, atomic_get(&uart.length));
+
+	for (size_t i = 0; i < NUM_SOURCES; i++) {
+		zassert_equal(receiver.next_seq[i], NUM_WAKEUP_MESSAGES);
+	}
+
+	for (size_t i = 0; i < NUM_PRODUCERS; i++) {
+		TC_PRINT("producer %zu: cobs_tx_queue_submit took at most %u cycles\n", i,
+			 uart.max_submit_cycles[i]);
+	}
+}
+
+static void before(void *const fixture)
+{
+	cobs_tx_queue_init(&test_queue);
+
+	memset(&receiver, 0, sizeof(receiver));
+	cobs_decode_reset(&receiver.decode);
+
+	memset(&uart, 0, sizeof(uart));
+}
+
+ZTEST_SUITE(cobs_tx_queue_test, NULL, NULL, before, NULL, NULL);
@@ -47,6 +47,82 @@ size_t cobs_encode_stream_simple(const uint8_t *const input, const size_t input_
 	return num_written;
 }
 
+size_t cobs_encode_flat_simple(const uint8_t *const input, const size_t input_length,
+			       uint8_t *const output, const size_t output_length,
+			       const size_t chunk_size)
+{
+	struct cobs_encode_flat encode;
+	size_t num_written = 0;
+
+	cobs_encode_flat_init(&encode, input, input_length);
+
+	while (true) {
+		const size_t length = MIN(chunk_size, output_length - num_written);
+		const size_t nbytes = cobs_encode_flat(&encode, &output[num_written], length);
+		if (nbytes == 0) {
+			break;
+		}
+
+		num_written += nbytes;
+	}
+
+	const uint8_t last_byte = output[num_written - 1];
+	__ASSERT(last_byte == 0x00, "last byte is 0x%02x instead ox 0x00", last_byte);
+
+	return num_written;
+}
+
+size_t cobs_encode_append_simple(const uint8_t *const input, const size_t input_length,
+				 uint8_t *const output, const size_t output_length,
+				 const size_t input_chunk_size, const size_t output_chunk_size)
+{
+	struct cobs_encode_append encode;
+	size_t total_read = 0;
+	size_t total_written = 0;
+
+	cobs_encode_append_init(&encode);
+
+	while (total_read < input_length) {
+		const size_t input_size = MIN(input_chunk_size, input_length - total_read);
+		size_t chunk_read = 0;
+
+		/* Like a user with a small TX buffer, drain the output until the
+		 * chunk was consumed.
+		 */
+		while (chunk_read < input_size) {
+			size_t num_read;
+			size_t num_written;
+
+			cobs_encode_append(&encode, &input[total_read + chunk_read],
+					   input_size - chunk_read, &output[total_written],
+					   MIN(output_chunk_size, output_length - total_written),
+					   &num_read, &num_written);
+			__ASSERT_NO_MSG(num_read || num_written);
+
+			chunk_read += num_read;
+			total_written += num_written;
+		}
+
+		total_read += chunk_read;
+	}
+
+	while (true) {
+		const size_t nbytes = cobs_encode_append_finish(
+			&encode, &output[total_written],
+			MIN(output_chunk_size, output_length - total_written));
+		if (nbytes == 0) {
+			break;
+		}
+
+		total_written += nbytes;
+	}
+
+	const uint8_t last_byte = output[total_written - 1];
+	__ASSERT(last_byte == 0x00, "last byte is 0x%02x instead ox 0x00", last_byte);
+
+	return total_written;
+}
+
 int cobs_decode_stream_simple(const uint8_t *const input, const size_t input_length,
 			      uint8_t *const output, const size_t max_output_length,
 			      size_t *const ret_output_length)
@@ -94,3 +170,45 @@ int cobs_decode_stream_simple(const uint8_t *const input, const size_t input_len
 	*ret_output_length = output_length;
 	return 0;
 }
+
+int cobs_decode_isr_simple(const uint8_t *const input, const size_t input_length,
+			   uint8_t *const output, const size_t max_output_length,
+			   size_t *const ret_output_length)
+{
+	struct cobs_decode_isr decode = {0};
+	size_t output_length = 0;
+	bool finished = false;
+
+	for (size_t i = 0; i < input_length; i += 1) {
+		if (finished) {
+			return -EINVAL;
+		}
+
+		const int ret = cobs_decode_isr_step(&decode, input[i]);
+		if (ret >= 0) {
+			__ASSERT(max_output_length > output_length,
+				 "max_output_length=%zu, output_length=%zu", max_output_length,
+				 output_length);
+
+			output[output_length++] = ret;
+			continue;
+		}
+
+		switch (ret) {
+		case COBS_DECODE_ISR_NO_OUTPUT:
+			break;
+		case COBS_DECODE_ISR_FINISHED:
+			finished = true;
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	if (!finished) {
+		return -EINVAL;
+	}
+
+	*ret_output_length = output_length;
+	return 0;
+}
@@ -10,8 +10,20 @@ void unsafe_cobs_reset_encode_pool(void);
 size_t cobs_encode_stream_simple(const uint8_t *const input, const size_t input_length,
 				 uint8_t *const output, const size_t output_length);
 
+size_t cobs_encode_flat_simple(const uint8_t *const input, const size_t input_length,
+			       uint8_t *const output, const size_t output_length,
+			       const size_t chunk_size);
+
+size_t cobs_encode_append_simple(const uint8_t *const input, const size_t input_length,
+				 uint8_t *const output, const size_t output_length,
+				 const size_t input_chunk_size, const size_t output_chunk_size);
+
 int cobs_decode_stream_simple(const uint8_t *const input, const size_t input_length,
 			      uint8_t *const output, const size_t max_output_length,
 			      size_t *ret_output_size);
 
+int cobs_decode_isr_simple(const uint8_t *const input, const size_t input_length,
+			   uint8_t *const output, const size_t max_output_length,
+			   size_t *ret_output_size);
+
 #endif /* COBS_TESTUTILS_H */
@@ -0,0 +1,663 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Host tool for encoding files into frames and for decoding, splitting and
+ * validating captured streams of frames.
+ *
+ * Files are mapped into memory, pipes are read in large chunks. Since the
+ * zero-byte delimiter can't occur within a frame, captures are cut at
+ * delimiters into batches which are decoded on several threads.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cobs.h>
+
+/* Amount of input per thread and batch. */
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+/* Size of the output buffer of the encoder. */
+#define ENCODE_BUFFER_SIZE (1024 * 1024)
+
+#define MAX_THREADS 256
+
+enum mode {
+	MODE_DECODE,
+	MODE_SPLIT,
+	MODE_VALIDATE,
+};
+
+struct input {
+	int fd;
+	/** The whole file if it could be mapped, otherwise NULL. */
+	const uint8_t *map;
+	size_t map_size;
+	/** Buffer for data which is read from pipes. */
+	uint8_t *buf;
+	size_t buf_size;
+	size_t buf_length;
+	/** Data at the start of `buf` or `map` which was already returned. */
+	size_t consumed;
+	/** Offset of `buf` or `map` within the stream. */
+	uint64_t offset;
+	bool eof;
+};
+
+struct job {
+	enum mode mode;
+	const uint8_t *data;
+	size_t length;
+	/** Offset of `data` within the stream. */
+	uint64_t offset;
+
+	uint8_t *output;
+	size_t output_length;
+
+	size_t num_frames;
+	/** Ends of the decoded frames within `output`, only for splitting. */
+	size_t *frame_ends;
+	size_t frames_capacity;
+
+	/** Offsets of the invalid frames within the stream. */
+	uint64_t *invalid;
+	size_t num_invalid;
+	size_t invalid_capacity;
+};
+
+static const char *program = "cobs";
+
+static void die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	fprintf(stderr, "%s: ", program);
+	vfprintf(stderr, fmt, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+
+	exit(2);
+}
+
+static void *xrealloc(void *ptr, size_t size)
+{
+	void *const ret = realloc(ptr, size);
+
+	if (!ret && size) {
+		die("out of memory");
+	}
+
+	return ret;
+}
+
+static void write_all(int fd, const uint8_t *data, size_t length)
+{
+	while (length > 0) {
+		const ssize_t ret = write(fd, data, length);
+
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			die("write: %s", strerror(errno));
+		}
+
+		data += ret;
+		length -= ret;
+	}
+}
+
+static void input_open(struct input *in, const char *path)
+{
+	struct stat st;
+
+	*in = (struct input){0};
+
+	if (!path || strcmp(path, "-") == 0) {
+		in->fd = STDIN_FILENO;
+	} else {
+		in->fd = open(path, O_RDONLY);
+		if (in->fd < 0) {
+			die("%s: %s", path, strerror(errno));
+		}
+	}
+
+	if (fstat(in->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+	    (uint64_t)st.st_size <= SIZE_MAX) {
+		void *const map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, in->fd, 0);
+
+		if (map != MAP_FAILED) {
+			posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+			in->map = map;
+			in->map_size = st.st_size;
+		}
+	}
+}
+
+static void input_close(struct input *in)
+{
+	if (in->map) {
+		munmap((void *)in->map, in->map_size);
+	}
+
+	free(in->buf);
+
+	if (in->fd != STDIN_FILENO) {
+		close(in->fd);
+	}
+}
+
+/* Reads until `buf` holds at least `min_length` bytes or the end is reached. */
+static void input_fill(struct input *in, size_t min_length)
+{
+	if (min_length > in->buf_size) {
+		in->buf_size = MAX(min_length, 2 * in->buf_size);
+		in->buf = xrealloc(in->buf, in->buf_size);
+	}
+
+	while (!in->eof && in->buf_length < min_length) {
+		const ssize_t ret = read(in->fd, &in->buf[in->buf_length],
+					 in->buf_size - in->buf_length);
+
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			die("read: %s", strerror(errno));
+		}
+
+		in->eof = ret == 0;
+		in->buf_length += ret;
+	}
+}
+
+static const uint8_t *find_last_zero(const uint8_t *data, size_t length)
+{
+	while (length > 0) {
+		if (data[--length] == 0) {
+			return &data[length];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Get the next `max_length` bytes or more, up to and including a delimiter.
+ * Only the final data of the stream may not end with a delimiter. The data
+ * stays valid until the next call.
+ *
+ * Returns false at the end of the stream.
+ */
+static bool input_next(struct input *in, size_t max_length, const uint8_t **data, size_t *length,
+		       uint64_t *offset)
+{
+	if (in->map) {
+		const size_t start = in->consumed;
+		size_t end = start + MIN(max_length, in->map_size - start);
+
+		if (start == in->map_size) {
+			return false;
+		}
+
+		if (end < in->map_size) {
+			const uint8_t *const zero =
+				memchr(&in->map[end - 1], 0, in->map_size - (end - 1));
+
+			end = zero ? (size_t)(zero - in->map) + 1 : in->map_size;
+		}
+
+		in->consumed = end;
+		*data = &in->map[start];
+		*length = end - start;
+		*offset = start;
+		return true;
+	}
+
+	/* Keep the rest of the previous data, which is the start of a frame. */
+	memmove(in->buf, &in->buf[in->consumed], in->buf_length - in->consumed);
+	in->buf_length -= in->consumed;
+	in->offset += in->consumed;
+	in->consumed = 0;
+
+	size_t searched = 0;
+
+	for (;;) {
+		input_fill(in, searched + max_length);
+
+		const uint8_t *const zero =
+			find_last_zero(&in->buf[searched], in->buf_length - searched);
+
+		if (zero) {
+			in->consumed = zero - in->buf + 1;
+			break;
+		}
+
+		if (in->eof) {
+			in->consumed = in->buf_length;
+			break;
+		}
+
+		/* A frame which is longer than max_length. */
+		searched = in->buf_length;
+	}
+
+	*data = in->buf;
+	*length = in->consumed;
+	*offset = in->offset;
+	return *length > 0;
+}
+
+static void job_add_invalid(struct job *job, const uint8_t *frame)
+{
+	if (job->num_invalid == job->invalid_capacity) {
+		job->invalid_capacity = MAX(16, 2 * job->invalid_capacity);
+		job->invalid =
+			xrealloc(job->invalid, job->invalid_capacity * sizeof(*job->invalid));
+	}
+
+	job->invalid[job->num_invalid++] = job->offset + (frame - job->data);
+}
+
+static void job_add_frame(struct job *job)
+{
+	if (job->mode != MODE_SPLIT) {
+		job->num_frames++;
+		return;
+	}
+
+	if (job->num_frames == job->frames_capacity) {
+		job->frames_capacity = MAX(1024, 2 * job->frames_capacity);
+		job->frame_ends =
+			xrealloc(job->frame_ends, job->frames_capacity * sizeof(*job->frame_ends));
+	}
+
+	job->frame_ends[job->num_frames++] = job->output_length;
+}
+
+static int validate_frame(const uint8_t *frame, size_t length)
+{
+	struct cobs_decode_runs runs;
+	const uint8_t *run;
+	size_t run_length;
+	bool followed_by_zero;
+	int ret;
+
+	cobs_decode_runs_init(&runs, frame, length);
+
+	do {
+		ret = cobs_decode_runs_next(&runs, &run, &run_length, &followed_by_zero);
+	} while (ret > 0);
+
+	return ret;
+}
+
+static void *job_run(void *arg)
+{
+	struct job *const job = arg;
+	const uint8_t *frame = job->data;
+	const uint8_t *const end = &job->data[job->length];
+
+	job->output_length = 0;
+	job->num_frames = 0;
+	job->num_invalid = 0;
+
+	if (job->mode != MODE_VALIDATE) {
+		/* The decoded data is never longer than the encoded data. */
+		job->output = xrealloc(job->output, job->length);
+	}
+
+	while (frame < end) {
+		const uint8_t *const zero = memchr(frame, 0, end - frame);
+		const size_t length = (zero ? zero : end) - frame;
+		size_t decoded_length;
+		int ret;
+
+		if (!zero) {
+			/* Truncated at the end of the stream. */
+			job_add_invalid(job, frame);
+			break;
+		}
+
+		/* Consecutive delimiters are used for synchronization. */
+		if (length == 0) {
+			frame++;
+			continue;
+		}
+
+		if (job->mode == MODE_VALIDATE) {
+			ret = validate_frame(frame, length);
+		} else {
+			ret = cobs_decode(frame, length, &job->output[job->output_length],
+					  &decoded_length);
+		}
+
+		if (ret) {
+			job_add_invalid(job, frame);
+		} else {
+			if (job->mode != MODE_VALIDATE) {
+				job->output_length += decoded_length;
+			}
+			job_add_frame(job);
+		}
+
+		frame = zero + 1;
+	}
+
+	return NULL;
+}
+
+static void write_frames(const struct job *job, const char *prefix, size_t index)
+{
+	size_t start = 0;
+
+	for (size_t i = 0; i < job->num_frames; i++) {
+		char path[4096];
+
+		snprintf(path, sizeof(path), "%s%08zu", prefix, index + i);
+
+		const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			die("%s: %s", path, strerror(errno));
+		}
+
+		write_all(fd, &job->output[start], job->frame_ends[i] - start);
+		close(fd);
+
+		start = job->frame_ends[i];
+	}
+}
+
+static int run_decode(enum mode mode, struct input *in, int out_fd, const char *prefix,
+		      unsigned int num_threads)
+{
+	struct job jobs[MAX_THREADS] = {0};
+	pthread_t threads[MAX_THREADS];
+	size_t num_frames = 0;
+	size_t num_invalid = 0;
+	const uint8_t *data;
+	size_t length;
+	uint64_t offset;
+
+	while (input_next(in, (size_t)num_threads * CHUNK_SIZE, &data, &length, &offset)) {
+		const uint8_t *const end = &data[length];
+		unsigned int num_jobs = 0;
+
+		/* Cut the batch into one job per thread, right behind a
+		 * delimiter.
+		 */
+		while (data < end) {
+			const size_t left = end - data;
+			const size_t share = (left + (num_threads - num_jobs) - 1) /
+					     (num_threads - num_jobs);
+			const uint8_t *const zero = memchr(&data[share - 1], 0, left - (share - 1));
+			const uint8_t *const job_end = zero ? zero + 1 : end;
+			struct job *const job = &jobs[num_jobs];
+
+			job->mode = mode;
+			job->data = data;
+			job->length = job_end - data;
+			job->offset = offset;
+
+			offset += job->length;
+			data = job_end;
+			num_jobs++;
+		}
+
+		for (unsigned int i = 1; i < num_jobs; i++) {
+			const int ret = pthread_create(&threads[i], NULL, job_run, &jobs[i]);
+
+			if (ret) {
+				die("pthread_create: %s", strerror(ret));
+			}
+		}
+
+		job_run(&jobs[0]);
+
+		for (unsigned int i = 0; i < num_jobs; i++) {
+			const struct job *const job = &jobs[i];
+
+			if (i > 0) {
+				pthread_join(threads[i], NULL);
+			}
+
+			for (size_t j = 0; j < job->num_invalid; j++) {
+				fprintf(stderr, "%s: invalid frame at offset %llu\n", program,
+					(unsigned long long)job->invalid[j]);
+			}
+
+			if (mode == MODE_DECODE) {
+				write_all(out_fd, job->output, job->output_length);
+			} else if (mode == MODE_SPLIT) {
+				write_frames(job, prefix, num_frames);
+			}
+
+			num_frames += job->num_frames;
+			num_invalid += job->num_invalid;
+		}
+	}
+
+	for (unsigned int i = 0; i < MAX_THREADS; i++) {
+		free(jobs[i].output);
+		free(jobs[i].frame_ends);
+		free(jobs[i].invalid);
+	}
+
+	if (mode == MODE_VALIDATE) {
+		printf("%zu valid frames, %zu invalid frames\n", num_frames, num_invalid);
+	}
+
+	return num_invalid ? 1 : 0;
+}
+
+static void encode_finish(struct cobs_encode_append *encode, uint8_t *output, size_t *num_written,
+			  int out_fd)
+{
+	for (;;) {
+		const size_t ret = cobs_encode_append_finish(encode, &output[*num_written],
+							     ENCODE_BUFFER_SIZE - *num_written);
+
+		*num_written += ret;
+		if (ret == 0) {
+			break;
+		}
+
+		if (*num_written == ENCODE_BUFFER_SIZE) {
+			write_all(out_fd, output, *num_written);
+			*num_written = 0;
+		}
+	}
+
+	cobs_encode_append_init(encode);
+}
+
+static int run_encode(struct input *in, int out_fd, size_t frame_size)
+{
+	struct cobs_encode_append encode;
+	uint8_t *const output = xrealloc(NULL, ENCODE_BUFFER_SIZE);
+	size_t num_written = 0;
+	/* Data of the current frame which was passed to the encoder. */
+	size_t frame_length = 0;
+	bool any_data = false;
+
+	cobs_encode_append_init(&encode);
+
+	for (;;) {
+		const uint8_t *data;
+		size_t length;
+
+		if (in->map) {
+			if (in->consumed == in->map_size) {
+				break;
+			}
+
+			data = &in->map[in->consumed];
+			length = MIN(CHUNK_SIZE, in->map_size - in->consumed);
+			in->consumed += length;
+		} else {
+			in->buf_length = 0;
+			input_fill(in, CHUNK_SIZE);
+			if (in->buf_length == 0) {
+				break;
+			}
+
+			data = in->buf;
+			length = in->buf_length;
+		}
+
+		any_data = true;
+
+		while (length > 0) {
+			const size_t max_length =
+				frame_size ? MIN(length, frame_size - frame_length) : length;
+			size_t num_read;
+			size_t chunk_written;
+
+			cobs_encode_append(&encode, data, max_length, &output[num_written],
+					   ENCODE_BUFFER_SIZE - num_written, &num_read,
+					   &chunk_written);
+
+			data += num_read;
+			length -= num_read;
+			frame_length += num_read;
+			num_written += chunk_written;
+
+			if (num_written == ENCODE_BUFFER_SIZE ||
+			    (num_read == 0 && chunk_written == 0)) {
+				write_all(out_fd, output, num_written);
+				num_written = 0;
+			}
+
+			if (frame_size && frame_length == frame_size) {
+				encode_finish(&encode, output, &num_written, out_fd);
+				frame_length = 0;
+			}
+		}
+	}
+
+	/* The last, short frame. An empty input is encoded into an empty frame
+	 * unless it's split into frames.
+	 */
+	if (frame_length > 0 || (!frame_size && !any_data)) {
+		encode_finish(&encode, output, &num_written, out_fd);
+	}
+
+	write_all(out_fd, output, num_written);
+	free(output);
+
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: %s encode [-s FRAME_SIZE] [INPUT [OUTPUT]]\n"
+		"       %s decode [-j THREADS] [INPUT [OUTPUT]]\n"
+		"       %s split [-j THREADS] -o PREFIX [INPUT]\n"
+		"       %s validate [-j THREADS] [INPUT]\n"
+		"\n"
+		"encode    Encode INPUT into one frame, or into frames of FRAME_SIZE bytes,\n"
+		"          each followed by a zero-byte.\n"
+		"decode    Decode all frames of INPUT and write their data.\n"
+		"split     Decode all frames of INPUT, each into its own file PREFIXnnnnnnnn.\n"
+		"validate  Check all frames of INPUT.\n"
+		"\n"
+		"INPUT and OUTPUT default to stdin and stdout. Invalid frames are reported\n"
+		"with their offsets and result in exit status 1.\n",
+		program, program, program, program);
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	const char *prefix = NULL;
+	size_t frame_size = 0;
+	long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	struct input in;
+	enum mode mode = MODE_DECODE;
+	bool encode = false;
+	int out_fd = STDOUT_FILENO;
+	int ret;
+	int opt;
+
+	if (argc < 2) {
+		usage();
+	}
+
+	const char *const command = argv[1];
+
+	if (strcmp(command, "encode") == 0) {
+		encode = true;
+	} else if (strcmp(command, "decode") == 0) {
+		mode = MODE_DECODE;
+	} else if (strcmp(command, "split") == 0) {
+		mode = MODE_SPLIT;
+	} else if (strcmp(command, "validate") == 0) {
+		mode = MODE_VALIDATE;
+	} else {
+		usage();
+	}
+
+	argc--;
+	argv++;
+
+	while ((opt = getopt(argc, argv, "s:j:o:")) != -1) {
+		switch (opt) {
+		case 's':
+			frame_size = strtoull(optarg, NULL, 0);
+			break;
+		case 'j':
+			num_threads = strtol(optarg, NULL, 0);
+			break;
+		case 'o':
+			prefix = optarg;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	const int num_args = argc - optind;
+	const int max_args = encode || mode == MODE_DECODE ? 2 : 1;
+
+	if (num_args > max_args || (!encode && mode == MODE_SPLIT && !prefix)) {
+		usage();
+	}
+
+	num_threads = MIN(MAX(num_threads, 1), MAX_THREADS);
+
+	input_open(&in, num_args > 0 ? argv[optind] : NULL);
+
+	if (num_args > 1 && strcmp(argv[optind + 1], "-") != 0) {
+		out_fd = open(argv[optind + 1], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (out_fd < 0) {
+			die("%s: %s", argv[optind + 1], strerror(errno));
+		}
+	}
+
+	if (encode) {
+		ret = run_encode(&in, out_fd, frame_size);
+	} else {
+		ret = run_decode(mode, &in, out_fd, prefix, num_threads);
+	}
+
+	input_close(&in);
+
+	if (out_fd != STDOUT_FILENO && close(out_fd)) {
+		die("close: %s", strerror(errno));
+	}
+
+	return ret;
+}
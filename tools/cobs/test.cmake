@@ -0,0 +1,53 @@
+# SPDX-License-Identifier: MIT
+
+# Roundtrip tests of the tool, using its own binary as data with plenty of
+# zero-bytes.
+
+function(run expected_result)
+	execute_process(COMMAND ${ARGN} RESULT_VARIABLE result OUTPUT_VARIABLE output)
+	if(NOT result EQUAL expected_result)
+		message(FATAL_ERROR "${ARGN}: exit status ${result} instead of ${expected_result}")
+	endif()
+	set(output "${output}" PARENT_SCOPE)
+endfunction()
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR}/split)
+set(data ${COBS})
+
+foreach(frame_size 0 1 254 255 1000 100000)
+	set(encoded ${WORK_DIR}/encoded-${frame_size})
+
+	run(0 ${COBS} encode -s ${frame_size} ${data} ${encoded})
+	run(0 ${COBS} validate ${encoded})
+
+	foreach(threads 1 3)
+		run(0 ${COBS} decode -j ${threads} ${encoded} ${WORK_DIR}/decoded)
+		run(0 ${CMAKE_COMMAND} -E compare_files ${data} ${WORK_DIR}/decoded)
+	endforeach()
+
+	# Through pipes, which are read instead of mapped.
+	run(0 sh -c "cat ${data} | ${COBS} encode -s ${frame_size} | ${COBS} decode -j 2 > ${WORK_DIR}/decoded")
+	run(0 ${CMAKE_COMMAND} -E compare_files ${data} ${WORK_DIR}/decoded)
+endforeach()
+
+run(0 ${COBS} encode -s 1000 ${data} ${WORK_DIR}/encoded)
+file(SIZE ${data} data_size)
+math(EXPR num_frames "(${data_size} + 999) / 1000")
+
+run(0 ${COBS} split -j 4 -o ${WORK_DIR}/split/frame- ${WORK_DIR}/encoded)
+file(GLOB frames ${WORK_DIR}/split/frame-*)
+list(LENGTH frames num_files)
+if(NOT num_files EQUAL num_frames)
+	message(FATAL_ERROR "split into ${num_files} instead of ${num_frames} frames")
+endif()
+
+file(READ ${WORK_DIR}/split/frame-00000000 first_frame HEX)
+file(READ ${data} expected_frame LIMIT 1000 HEX)
+if(NOT first_frame STREQUAL expected_frame)
+	message(FATAL_ERROR "wrong data in the first frame")
+endif()
+
+# The raw binary is no valid stream of frames.
+run(1 ${COBS} validate ${data})
+run(1 ${COBS} decode ${data} ${WORK_DIR}/decoded)
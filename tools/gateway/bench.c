@@ -0,0 +1,198 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Measures the frames per second which the gateway receives from a growing
+ * number of pseudo-terminals, each fed by writer threads as fast as possible.
+ *
+ * usage: cobs-gateway-bench [MAX_PORTS [FRAME_SIZE [SECONDS]]]
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <cobs.h>
+
+#include "gateway.h"
+#include "pty.h"
+
+#define NUM_WRITERS 4
+#define NUM_WORKERS 4
+
+/* Frames written to a port at once. */
+#define FRAMES_PER_WRITE 16
+
+struct writer {
+	pthread_t thread;
+	const int *slaves;
+	unsigned int first_port;
+	unsigned int num_ports;
+	const uint8_t *block;
+	size_t block_length;
+	uint64_t num_frames;
+};
+
+static atomic_bool writers_stop;
+static atomic_uint_fast64_t num_received;
+
+static void frame_cb(void *user_data, unsigned int port, const uint8_t *data, size_t length)
+{
+	atomic_fetch_add_explicit(&num_received, 1, memory_order_relaxed);
+}
+
+static void *writer_main(void *arg)
+{
+	struct writer *const writer = arg;
+
+	while (!atomic_load(&writers_stop)) {
+		for (unsigned int i = 0; i < writer->num_ports; i++) {
+			if (pty_write(writer->slaves[writer->first_port + i], writer->block,
+				      writer->block_length) < 0) {
+				perror("write");
+				exit(2);
+			}
+
+			writer->num_frames += FRAMES_PER_WRITE;
+		}
+	}
+
+	return NULL;
+}
+
+static void *run_main(void *arg)
+{
+	return (void *)(intptr_t)gateway_run(arg);
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run(unsigned int num_ports, size_t frame_size, double seconds)
+{
+	uint8_t *const frame = malloc(frame_size);
+	uint8_t *const block = malloc(FRAMES_PER_WRITE * (COBS_MAX_ENCODED_SIZE(frame_size) + 1));
+	int *const masters = calloc(num_ports, sizeof(int));
+	int *const slaves = calloc(num_ports, sizeof(int));
+	const unsigned int num_writers = MIN(num_ports, NUM_WRITERS);
+	struct writer writers[NUM_WRITERS];
+	struct gateway_stats stats;
+	struct gateway *gateway;
+	size_t block_length = 0;
+	pthread_t runner;
+	uint64_t num_sent = 0;
+	int ret;
+
+	if (!frame || !block || !masters || !slaves) {
+		fprintf(stderr, "out of memory\n");
+		exit(2);
+	}
+
+	for (size_t i = 0; i < frame_size; i++) {
+		frame[i] = i % 7 == 0 ? 0x00 : i;
+	}
+
+	for (unsigned int i = 0; i < FRAMES_PER_WRITE; i++) {
+		block_length += cobs_encode(frame, frame_size, &block[block_length]);
+		block[block_length++] = 0x00;
+	}
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		ret = pty_open(&masters[i], &slaves[i]);
+		if (ret < 0) {
+			fprintf(stderr, "pty_open: %s\n", strerror(-ret));
+			exit(2);
+		}
+	}
+
+	const struct gateway_config config = {
+		.fds = masters,
+		.num_ports = num_ports,
+		.num_workers = NUM_WORKERS,
+		.cb = frame_cb,
+	};
+
+	ret = gateway_create(&gateway, &config);
+	if (ret < 0) {
+		fprintf(stderr, "gateway_create: %s\n", strerror(-ret));
+		exit(2);
+	}
+
+	atomic_store(&writers_stop, false);
+	atomic_store(&num_received, 0);
+	pthread_create(&runner, NULL, run_main, gateway);
+
+	const double start = now();
+
+	for (unsigned int i = 0; i < num_writers; i++) {
+		writers[i] = (struct writer){
+			.slaves = slaves,
+			.first_port = i * num_ports / num_writers,
+			.num_ports = (i + 1) * num_ports / num_writers - i * num_ports / num_writers,
+			.block = block,
+			.block_length = block_length,
+		};
+		pthread_create(&writers[i].thread, NULL, writer_main, &writers[i]);
+	}
+
+	usleep(seconds * 1e6);
+	atomic_store(&writers_stop, true);
+
+	for (unsigned int i = 0; i < num_writers; i++) {
+		pthread_join(writers[i].thread, NULL);
+		num_sent += writers[i].num_frames;
+	}
+
+	while (atomic_load(&num_received) < num_sent) {
+		usleep(1000);
+	}
+
+	const double elapsed = now() - start;
+
+	gateway_stop(gateway);
+	pthread_join(runner, NULL);
+	gateway_stats_get(gateway, &stats);
+
+	printf("%6u %12.0f %10.1f %12.1f\n", num_ports, stats.frames / elapsed,
+	       stats.bytes / elapsed / 1e6, (double)stats.frames / stats.syscalls);
+
+	gateway_destroy(gateway);
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		close(slaves[i]);
+		close(masters[i]);
+	}
+
+	free(slaves);
+	free(masters);
+	free(block);
+	free(frame);
+}
+
+int main(int argc, char **argv)
+{
+	const unsigned int max_ports = argc > 1 ? strtoul(argv[1], NULL, 0) : 256;
+	const size_t frame_size = argc > 2 ? strtoull(argv[2], NULL, 0) : 64;
+	const double seconds = argc > 3 ? strtod(argv[3], NULL) : 1.0;
+
+	printf("frame size %zu bytes\n", frame_size);
+	printf("%6s %12s %10s %12s\n", "ports", "frames/s", "MB/s", "frames/enter");
+
+	for (unsigned int num_ports = 1; num_ports <= max_ports; num_ports *= 4) {
+		run(num_ports, frame_size, seconds);
+	}
+
+	return 0;
+}
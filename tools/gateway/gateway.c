@@ -0,0 +1,702 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * The io_uring is used through its system calls directly, so the gateway
+ * builds without liburing. Every port has one read in flight at all times. A
+ * single io_uring_enter submits the reads of all ports which were handled in
+ * the previous round and waits for the next completions, so with many busy
+ * ports, a round trip into the kernel serves many reads.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cobs.h>
+
+#include "gateway.h"
+
+#define DEFAULT_MAX_FRAME_SIZE (64 * 1024)
+#define DEFAULT_READ_SIZE      4096
+
+/* The io_uring limits the number of entries and registered buffers. */
+#define MAX_PORTS 16384
+
+/* user_data of the read of the eventfd of gateway_stop. */
+#define STOP_TAG UINT64_MAX
+
+/* Flag of the user_data of a poll of a port, which is queued instead of a
+ * read while the port has no data and was opened with O_NONBLOCK.
+ */
+#define POLL_TAG (UINT64_C(1) << 32)
+
+struct frame {
+	struct frame *next;
+	unsigned int port;
+	size_t length;
+	uint8_t data[];
+};
+
+struct frame_list {
+	struct frame *head;
+	struct frame **tail;
+};
+
+struct worker {
+	struct gateway *gateway;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	/** Frames which weren't handled yet. */
+	struct frame_list frames;
+	bool stop;
+	/** Frames of the current round of completions, only used by gateway_run. */
+	struct frame_list batch;
+};
+
+struct port {
+	int fd;
+	/** Read buffer, registered with the io_uring if `gateway->registered`. */
+	uint8_t *read_buf;
+	/** Decoder of the current frame. */
+	struct cobs_decode decode;
+	/** The current frame. */
+	uint8_t *frame;
+	size_t length;
+	/** If true, bytes of the current frame were received. */
+	bool started;
+	/** If true, the input is skipped up to the next zero-byte. */
+	bool discard;
+};
+
+struct ring {
+	int fd;
+	void *sq_map;
+	size_t sq_map_size;
+	void *cq_map;
+	size_t cq_map_size;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int sq_mask;
+	unsigned int *sq_array;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int cq_mask;
+	struct io_uring_cqe *cqes;
+
+	/** Entries which were queued but not submitted yet. */
+	unsigned int to_submit;
+};
+
+struct gateway {
+	struct gateway_config config;
+	struct ring ring;
+	struct port *ports;
+	struct worker *workers;
+	uint8_t *read_bufs;
+	size_t read_bufs_size;
+	bool registered;
+	int stop_fd;
+	uint64_t stop_value;
+	struct gateway_stats stats;
+};
+
+static int io_uring_setup(unsigned int entries, struct io_uring_params *params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+			  unsigned int flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int io_uring_register(int fd, unsigned int opcode, const void *arg, unsigned int nr_args)
+{
+	return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void ring_unmap(struct ring *ring)
+{
+	if (ring->sqes) {
+		munmap(ring->sqes, ring->sqes_size);
+	}
+
+	if (ring->cq_map && ring->cq_map != ring->sq_map) {
+		munmap(ring->cq_map, ring->cq_map_size);
+	}
+
+	if (ring->sq_map) {
+		munmap(ring->sq_map, ring->sq_map_size);
+	}
+}
+
+static int ring_init(struct ring *ring, unsigned int entries)
+{
+	struct io_uring_params params = {0};
+
+	*ring = (struct ring){0};
+
+	ring->fd = io_uring_setup(entries, &params);
+	if (ring->fd < 0) {
+		return -errno;
+	}
+
+	ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		ring->sq_map_size = MAX(ring->sq_map_size, ring->cq_map_size);
+		ring->cq_map_size = ring->sq_map_size;
+	}
+
+	ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if (ring->sq_map == MAP_FAILED) {
+		ring->sq_map = NULL;
+		goto fail;
+	}
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		ring->cq_map = ring->sq_map;
+	} else {
+		ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE,
+				    MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+		if (ring->cq_map == MAP_FAILED) {
+			ring->cq_map = NULL;
+			goto fail;
+		}
+	}
+
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			  ring->fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		ring->sqes = NULL;
+		goto fail;
+	}
+
+	uint8_t *const sq = ring->sq_map;
+	uint8_t *const cq = ring->cq_map;
+
+	ring->sq_head = (unsigned int *)(sq + params.sq_off.head);
+	ring->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+	ring->sq_mask = *(unsigned int *)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned int *)(sq + params.sq_off.array);
+	ring->cq_head = (unsigned int *)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+	ring->cq_mask = *(unsigned int *)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+	return 0;
+
+fail: {
+	const int ret = -errno;
+
+	ring_unmap(ring);
+	close(ring->fd);
+	return ret;
+}
+}
+
+static void ring_free(struct ring *ring)
+{
+	ring_unmap(ring);
+	close(ring->fd);
+}
+
+/* Queues an entry, the ring is large enough for a read of every port and of
+ * the eventfd, so it can't be full.
+ */
+static struct io_uring_sqe *ring_get_sqe(struct ring *ring)
+{
+	const unsigned int tail = *ring->sq_tail;
+	const unsigned int index = tail & ring->sq_mask;
+	struct io_uring_sqe *const sqe = &ring->sqes[index];
+
+	memset(sqe, 0, sizeof(*sqe));
+	ring->sq_array[index] = index;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+
+	return sqe;
+}
+
+/* Submits the queued entries and waits for at least one completion. */
+static int ring_submit_and_wait(struct ring *ring)
+{
+	for (;;) {
+		const int ret =
+			io_uring_enter(ring->fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS);
+
+		if (ret >= 0) {
+			ring->to_submit -= ret;
+			return 0;
+		}
+
+		if (errno != EINTR) {
+			return -errno;
+		}
+	}
+}
+
+static void queue_read(struct gateway *gateway, unsigned int index)
+{
+	struct port *const port = &gateway->ports[index];
+	struct io_uring_sqe *const sqe = ring_get_sqe(&gateway->ring);
+
+	sqe->opcode = gateway->registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	sqe->fd = port->fd;
+	sqe->addr = (uintptr_t)port->read_buf;
+	sqe->len = gateway->config.read_size;
+	/* Ports are streams, read from the current position. */
+	sqe->off = (uint64_t)-1;
+	sqe->buf_index = gateway->registered ? index : 0;
+	sqe->user_data = index;
+}
+
+static void queue_poll(struct gateway *gateway, unsigned int index)
+{
+	struct io_uring_sqe *const sqe = ring_get_sqe(&gateway->ring);
+
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = gateway->ports[index].fd;
+	sqe->poll_events = POLLIN;
+	sqe->user_data = POLL_TAG | index;
+}
+
+static void queue_stop_read(struct gateway *gateway)
+{
+	struct io_uring_sqe *const sqe = ring_get_sqe(&gateway->ring);
+
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = gateway->stop_fd;
+	sqe->addr = (uintptr_t)&gateway->stop_value;
+	sqe->len = sizeof(gateway->stop_value);
+	sqe->off = (uint64_t)-1;
+	sqe->user_data = STOP_TAG;
+}
+
+static void frame_list_init(struct frame_list *list)
+{
+	list->head = NULL;
+	list->tail = &list->head;
+}
+
+static void frame_list_append(struct frame_list *list, struct frame_list *other)
+{
+	if (other->head) {
+		*list->tail = other->head;
+		list->tail = other->tail;
+		frame_list_init(other);
+	}
+}
+
+static void *worker_main(void *arg)
+{
+	struct worker *const worker = arg;
+	const struct gateway_config *const config = &worker->gateway->config;
+
+	for (;;) {
+		struct frame_list frames;
+
+		frame_list_init(&frames);
+
+		pthread_mutex_lock(&worker->lock);
+		while (!worker->frames.head && !worker->stop) {
+			pthread_cond_wait(&worker->cond, &worker->lock);
+		}
+		frame_list_append(&frames, &worker->frames);
+		const bool stop = worker->stop;
+		pthread_mutex_unlock(&worker->lock);
+
+		if (!frames.head && stop) {
+			return NULL;
+		}
+
+		struct frame *next;
+
+		for (struct frame *frame = frames.head; frame; frame = next) {
+			next = frame->next;
+			config->cb(config->user_data, frame->port, frame->data, frame->length);
+			free(frame);
+		}
+	}
+}
+
+/* Passes the frames of this round to the workers, with one lock per worker. */
+static void dispatch(struct gateway *gateway)
+{
+	for (unsigned int i = 0; i < gateway->config.num_workers; i++) {
+		struct worker *const worker = &gateway->workers[i];
+
+		if (!worker->batch.head) {
+			continue;
+		}
+
+		pthread_mutex_lock(&worker->lock);
+		frame_list_append(&worker->frames, &worker->batch);
+		pthread_cond_signal(&worker->cond);
+		pthread_mutex_unlock(&worker->lock);
+	}
+}
+
+static void end_frame(struct port *port)
+{
+	port->length = 0;
+	port->started = false;
+	port->discard = false;
+	cobs_decode_reset(&port->decode);
+}
+
+static void deliver_frame(struct gateway *gateway, unsigned int index)
+{
+	struct port *const port = &gateway->ports[index];
+	struct frame *const frame = malloc(sizeof(*frame) + port->length);
+
+	if (!frame) {
+		gateway->stats.errors++;
+		return;
+	}
+
+	frame->next = NULL;
+	frame->port = index;
+	frame->length = port->length;
+	memcpy(frame->data, port->frame, port->length);
+
+	struct frame_list *const batch =
+		&gateway->workers[index % gateway->config.num_workers].batch;
+
+	*batch->tail = frame;
+	batch->tail = &frame->next;
+	gateway->stats.frames++;
+}
+
+static void decode(struct gateway *gateway, unsigned int index, size_t length)
+{
+	struct port *const port = &gateway->ports[index];
+	const uint8_t *input = port->read_buf;
+
+	while (length > 0) {
+		if (port->discard) {
+			const uint8_t *const zero = memchr(input, 0, length);
+			if (!zero) {
+				break;
+			}
+
+			length -= zero + 1 - input;
+			input = zero + 1;
+			end_frame(port);
+			continue;
+		}
+
+		/* Delimiters between frames. */
+		if (!port->started && input[0] == 0) {
+			input++;
+			length--;
+			continue;
+		}
+
+		size_t num_read;
+		size_t num_written;
+		enum cobs_decode_result result = cobs_decode_stream(
+			&port->decode, input, length, &port->frame[port->length],
+			gateway->config.max_frame_size - port->length, &num_read, &num_written);
+
+		input += num_read;
+		length -= num_read;
+		port->length += num_written;
+		port->started = true;
+
+		if (result == COBS_DECODE_RESULT_CONSUMED && length > 0) {
+			/* The buffer is full. The frame still fits if the next
+			 * byte is a code which doesn't add a zero.
+			 */
+			uint8_t output_byte;
+			bool output_available;
+
+			result = cobs_decode_stream_single(&port->decode, input[0], &output_byte,
+							   &output_available);
+			input++;
+			length--;
+
+			if (output_available) {
+				gateway->stats.errors++;
+				port->discard = true;
+				continue;
+			}
+		}
+
+		switch (result) {
+		case COBS_DECODE_RESULT_CONSUMED:
+			break;
+
+		case COBS_DECODE_RESULT_FINISHED:
+			deliver_frame(gateway, index);
+			end_frame(port);
+			break;
+
+		case COBS_DECODE_RESULT_UNEXPECTED_ZERO:
+		case COBS_DECODE_RESULT_ERROR:
+		default:
+			gateway->stats.errors++;
+			end_frame(port);
+			break;
+		}
+	}
+}
+
+static void register_buffers(struct gateway *gateway)
+{
+	const unsigned int num_ports = gateway->config.num_ports;
+	struct iovec *const iovecs = calloc(num_ports, sizeof(*iovecs));
+
+	if (!iovecs) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		iovecs[i] = (struct iovec){
+			.iov_base = gateway->ports[i].read_buf,
+			.iov_len = gateway->config.read_size,
+		};
+	}
+
+	/* Registering fails if the buffers exceed RLIMIT_MEMLOCK, plain reads
+	 * work nevertheless.
+	 */
+	gateway->registered = io_uring_register(gateway->ring.fd, IORING_REGISTER_BUFFERS, iovecs,
+						num_ports) == 0;
+	free(iovecs);
+}
+
+int gateway_create(struct gateway **gateway_out, const struct gateway_config *config)
+{
+	if (config->num_ports == 0 || config->num_ports > MAX_PORTS || !config->cb) {
+		return -EINVAL;
+	}
+
+	struct gateway *const gateway = calloc(1, sizeof(*gateway));
+	if (!gateway) {
+		return -ENOMEM;
+	}
+
+	gateway->config = *config;
+	gateway->config.num_workers = MAX(config->num_workers, 1);
+	gateway->config.max_frame_size = config->max_frame_size ?: DEFAULT_MAX_FRAME_SIZE;
+	gateway->config.read_size = config->read_size ?: DEFAULT_READ_SIZE;
+	gateway->stop_fd = -1;
+	gateway->ring.fd = -1;
+
+	const unsigned int num_ports = config->num_ports;
+	int ret = -ENOMEM;
+
+	gateway->ports = calloc(num_ports, sizeof(*gateway->ports));
+	gateway->workers = calloc(gateway->config.num_workers, sizeof(*gateway->workers));
+	if (!gateway->ports || !gateway->workers) {
+		goto fail;
+	}
+
+	gateway->read_bufs_size = (size_t)num_ports * gateway->config.read_size;
+	gateway->read_bufs = mmap(NULL, gateway->read_bufs_size, PROT_READ | PROT_WRITE,
+				  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (gateway->read_bufs == MAP_FAILED) {
+		gateway->read_bufs = NULL;
+		goto fail;
+	}
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		struct port *const port = &gateway->ports[i];
+
+		port->fd = config->fds[i];
+		port->read_buf = &gateway->read_bufs[i * gateway->config.read_size];
+		port->frame = malloc(gateway->config.max_frame_size);
+		if (!port->frame) {
+			goto fail;
+		}
+
+		end_frame(port);
+	}
+
+	gateway->stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (gateway->stop_fd < 0) {
+		ret = -errno;
+		goto fail;
+	}
+
+	/* One read per port and the one of the eventfd are in flight. */
+	ret = ring_init(&gateway->ring, num_ports + 1);
+	if (ret < 0) {
+		gateway->ring.fd = -1;
+		goto fail;
+	}
+
+	register_buffers(gateway);
+
+	*gateway_out = gateway;
+	return 0;
+
+fail:
+	gateway_destroy(gateway);
+	return ret;
+}
+
+int gateway_run(struct gateway *gateway)
+{
+	const unsigned int num_workers = gateway->config.num_workers;
+	unsigned int num_open = gateway->config.num_ports;
+	unsigned int num_started = 0;
+	bool stop = false;
+	int ret = 0;
+
+	for (; num_started < num_workers; num_started++) {
+		struct worker *const worker = &gateway->workers[num_started];
+
+		worker->gateway = gateway;
+		worker->stop = false;
+		frame_list_init(&worker->frames);
+		frame_list_init(&worker->batch);
+		pthread_mutex_init(&worker->lock, NULL);
+		pthread_cond_init(&worker->cond, NULL);
+
+		ret = -pthread_create(&worker->thread, NULL, worker_main, worker);
+		if (ret < 0) {
+			pthread_cond_destroy(&worker->cond);
+			pthread_mutex_destroy(&worker->lock);
+			goto out;
+		}
+	}
+
+	for (unsigned int i = 0; i < gateway->config.num_ports; i++) {
+		queue_read(gateway, i);
+	}
+
+	queue_stop_read(gateway);
+
+	struct ring *const ring = &gateway->ring;
+
+	while (num_open > 0 && !stop) {
+		ret = ring_submit_and_wait(ring);
+		if (ret < 0) {
+			break;
+		}
+
+		gateway->stats.syscalls++;
+
+		unsigned int head = *ring->cq_head;
+		const unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+		for (; head != tail; head++) {
+			const struct io_uring_cqe *const cqe = &ring->cqes[head & ring->cq_mask];
+
+			if (cqe->user_data == STOP_TAG) {
+				stop = true;
+				continue;
+			}
+
+			const unsigned int index = (unsigned int)cqe->user_data;
+
+			if (cqe->user_data & POLL_TAG) {
+				/* Data, a hang-up or an error, the read tells. */
+				if (cqe->res > 0) {
+					queue_read(gateway, index);
+				} else if (cqe->res == -EINTR) {
+					queue_poll(gateway, index);
+				} else {
+					num_open--;
+				}
+			} else if (cqe->res > 0) {
+				gateway->stats.bytes += cqe->res;
+				decode(gateway, index, cqe->res);
+				queue_read(gateway, index);
+			} else if (cqe->res == -EINTR) {
+				queue_read(gateway, index);
+			} else if (cqe->res == -EAGAIN) {
+				/* A non-blocking port without data. Retrying the
+				 * read right away would spin.
+				 */
+				queue_poll(gateway, index);
+			} else {
+				/* The end of the port, or an error like -EIO once
+				 * the other side of a pseudo-terminal was closed.
+				 */
+				num_open--;
+			}
+		}
+
+		__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+		dispatch(gateway);
+	}
+
+out:
+	for (unsigned int i = 0; i < num_started; i++) {
+		struct worker *const worker = &gateway->workers[i];
+
+		pthread_mutex_lock(&worker->lock);
+		worker->stop = true;
+		pthread_cond_signal(&worker->cond);
+		pthread_mutex_unlock(&worker->lock);
+
+		pthread_join(worker->thread, NULL);
+		pthread_cond_destroy(&worker->cond);
+		pthread_mutex_destroy(&worker->lock);
+	}
+
+	return ret;
+}
+
+void gateway_stop(struct gateway *gateway)
+{
+	const uint64_t value = 1;
+
+	(void)!write(gateway->stop_fd, &value, sizeof(value));
+}
+
+void gateway_stats_get(const struct gateway *gateway, struct gateway_stats *stats)
+{
+	*stats = gateway->stats;
+}
+
+void gateway_destroy(struct gateway *gateway)
+{
+	/* Closing the io_uring cancels the reads in flight, so it has to
+	 * happen before their buffers are freed.
+	 */
+	if (gateway->ring.fd >= 0) {
+		ring_free(&gateway->ring);
+	}
+
+	if (gateway->stop_fd >= 0) {
+		close(gateway->stop_fd);
+	}
+
+	if (gateway->ports) {
+		for (unsigned int i = 0; i < gateway->config.num_ports; i++) {
+			free(gateway->ports[i].frame);
+		}
+	}
+
+	if (gateway->read_bufs) {
+		munmap(gateway->read_bufs, gateway->read_bufs_size);
+	}
+
+	free(gateway->workers);
+	free(gateway->ports);
+	free(gateway);
+}
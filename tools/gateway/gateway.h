@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Gateway which receives frames from many serial ports on Linux.
+ *
+ * One thread reads from all ports through a single io_uring, with one
+ * registered buffer per port, and decodes the stream of every port with its
+ * own decoder state. Complete frames are passed to worker threads, always the
+ * same one for a port, so the frames of a port are handled in order.
+ */
+
+#ifndef COBS_GATEWAY_H_
+#define COBS_GATEWAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct gateway;
+
+/**
+ * Called on a worker thread for every frame. `data` is only valid during the
+ * call.
+ */
+typedef void (*gateway_frame_cb_t)(void *user_data, unsigned int port, const uint8_t *data,
+				   size_t length);
+
+struct gateway_config {
+	/** File descriptors of the ports, e.g. of serial devices or pseudo-terminals. */
+	const int *fds;
+	unsigned int num_ports;
+	/** Number of worker threads, 0 for one. */
+	unsigned int num_workers;
+	/** Size of the largest frame, longer ones are dropped. 0 for 64 KiB. */
+	size_t max_frame_size;
+	/** Size of the read buffer of each port. 0 for 4 KiB. */
+	size_t read_size;
+	gateway_frame_cb_t cb;
+	void *user_data;
+};
+
+struct gateway_stats {
+	/** Number of bytes read from all ports. */
+	uint64_t bytes;
+	/** Number of frames passed to the workers. */
+	uint64_t frames;
+	/** Number of frames which were invalid or too long. */
+	uint64_t errors;
+	/** Number of calls of io_uring_enter. */
+	uint64_t syscalls;
+};
+
+/**
+ * Create a gateway. The file descriptors stay owned by the caller.
+ *
+ * Returns 0 on success or a negative errno value, e.g. -ENOSYS if io_uring
+ * isn't available.
+ */
+int gateway_create(struct gateway **gateway, const struct gateway_config *config);
+
+/**
+ * Receive frames until all ports reached their end or #gateway_stop was
+ * called. All frames were handled by the workers once this returns. Can only
+ * be called once per gateway.
+ *
+ * Returns 0 on success or a negative errno value.
+ */
+int gateway_run(struct gateway *gateway);
+
+/** Make #gateway_run return. Can be called from any thread. */
+void gateway_stop(struct gateway *gateway);
+
+/** Get the statistics, only valid while #gateway_run isn't running. */
+void gateway_stats_get(const struct gateway *gateway, struct gateway_stats *stats);
+
+/** Destroy the gateway, #gateway_run must not be running. */
+void gateway_destroy(struct gateway *gateway);
+
+#endif /* COBS_GATEWAY_H_ */
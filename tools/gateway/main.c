@@ -0,0 +1,171 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Receives frames from serial ports and writes them to stdout, one line per
+ * frame with the index of its port and its data in hex.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "gateway.h"
+
+static const char *program = "cobs-gateway";
+static struct gateway *gateway;
+static pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void die(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	fprintf(stderr, "%s: ", program);
+	vfprintf(stderr, fmt, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+
+	exit(2);
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: %s [-j WORKERS] [-s MAX_FRAME_SIZE] [-q] PORT...\n"
+		"\n"
+		"Receives frames from all PORTs and writes them to stdout as\n"
+		"\"PORT HEX\" lines, or just counts them with -q. Stops at the end\n"
+		"of all ports or on SIGINT or SIGTERM.\n",
+		program);
+	exit(2);
+}
+
+static void print_frame(void *user_data, unsigned int port, const uint8_t *data, size_t length)
+{
+	static const char digits[] = "0123456789abcdef";
+	const bool *const quiet = user_data;
+
+	if (*quiet) {
+		return;
+	}
+
+	pthread_mutex_lock(&output_lock);
+	printf("%u ", port);
+	for (size_t i = 0; i < length; i++) {
+		putchar_unlocked(digits[data[i] >> 4]);
+		putchar_unlocked(digits[data[i] & 0x0F]);
+	}
+	putchar_unlocked('\n');
+	pthread_mutex_unlock(&output_lock);
+}
+
+static void stop_handler(int signal)
+{
+	gateway_stop(gateway);
+}
+
+static int open_port(const char *path)
+{
+	struct termios tio;
+	const int fd = open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC);
+
+	if (fd < 0) {
+		die("%s: %s", path, strerror(errno));
+	}
+
+	if (isatty(fd)) {
+		if (tcgetattr(fd, &tio)) {
+			die("%s: %s", path, strerror(errno));
+		}
+
+		cfmakeraw(&tio);
+
+		if (tcsetattr(fd, TCSANOW, &tio)) {
+			die("%s: %s", path, strerror(errno));
+		}
+	}
+
+	return fd;
+}
+
+int main(int argc, char **argv)
+{
+	struct gateway_config config = {0};
+	struct gateway_stats stats;
+	bool quiet = false;
+	int ret;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "j:s:q")) != -1) {
+		switch (opt) {
+		case 'j':
+			config.num_workers = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			config.max_frame_size = strtoull(optarg, NULL, 0);
+			break;
+		case 'q':
+			quiet = true;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (optind == argc) {
+		usage();
+	}
+
+	config.num_ports = argc - optind;
+	config.cb = print_frame;
+	config.user_data = &quiet;
+
+	int *const fds = calloc(config.num_ports, sizeof(*fds));
+	if (!fds) {
+		die("out of memory");
+	}
+
+	for (unsigned int i = 0; i < config.num_ports; i++) {
+		fds[i] = open_port(argv[optind + i]);
+	}
+
+	config.fds = fds;
+
+	ret = gateway_create(&gateway, &config);
+	if (ret < 0) {
+		die("gateway: %s", strerror(-ret));
+	}
+
+	signal(SIGINT, stop_handler);
+	signal(SIGTERM, stop_handler);
+
+	ret = gateway_run(gateway);
+	if (ret < 0) {
+		die("io_uring: %s", strerror(-ret));
+	}
+
+	fflush(stdout);
+	gateway_stats_get(gateway, &stats);
+	fprintf(stderr, "%llu frames, %llu errors, %llu bytes\n", (unsigned long long)stats.frames,
+		(unsigned long long)stats.errors, (unsigned long long)stats.bytes);
+
+	gateway_destroy(gateway);
+
+	for (unsigned int i = 0; i < config.num_ports; i++) {
+		close(fds[i]);
+	}
+	free(fds);
+
+	return stats.errors > 0;
+}
@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: MIT */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "pty.h"
+
+int pty_open(int *master, int *slave)
+{
+	struct termios tio;
+	int ret;
+
+	*master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if (*master < 0) {
+		return -errno;
+	}
+
+	if (grantpt(*master) || unlockpt(*master)) {
+		goto fail_master;
+	}
+
+	*slave = open(ptsname(*master), O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if (*slave < 0) {
+		goto fail_master;
+	}
+
+	/* Without raw mode, the line discipline would translate and echo. */
+	if (tcgetattr(*slave, &tio)) {
+		goto fail_slave;
+	}
+
+	cfmakeraw(&tio);
+
+	if (tcsetattr(*slave, TCSANOW, &tio)) {
+		goto fail_slave;
+	}
+
+	return 0;
+
+fail_slave:
+	ret = -errno;
+	close(*slave);
+	close(*master);
+	return ret;
+
+fail_master:
+	ret = -errno;
+	close(*master);
+	return ret;
+}
+
+int pty_write(int fd, const void *data, size_t length)
+{
+	const uint8_t *bytes = data;
+
+	while (length > 0) {
+		const ssize_t ret = write(fd, bytes, length);
+
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -errno;
+		}
+
+		bytes += ret;
+		length -= ret;
+	}
+
+	return 0;
+}
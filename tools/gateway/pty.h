@@ -0,0 +1,21 @@
+/* SPDX-License-Identifier: MIT */
+
+/* Pseudo-terminals standing in for serial ports in the test and benchmark. */
+
+#ifndef COBS_GATEWAY_PTY_H_
+#define COBS_GATEWAY_PTY_H_
+
+#include <stddef.h>
+
+/**
+ * Open a pseudo-terminal in raw mode. The gateway reads from `master`, data
+ * written to `slave` arrives there unchanged.
+ *
+ * Returns 0 on success or a negative errno value.
+ */
+int pty_open(int *master, int *slave);
+
+/** Write all of `data`, returns 0 on success or a negative errno value. */
+int pty_write(int fd, const void *data, size_t length);
+
+#endif /* COBS_GATEWAY_PTY_H_ */
@@ -0,0 +1,257 @@
+/* SPDX-License-Identifier: MIT */
+
+/*
+ * Test of the gateway with pseudo-terminals: frames of every port, written
+ * in pieces and interleaved with the other ports, arrive complete and in
+ * order, and invalid frames are dropped.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <cobs.h>
+
+#include "gateway.h"
+#include "pty.h"
+
+#define NUM_PORTS      32
+#define NUM_FRAMES     200
+#define MAX_FRAME_SIZE 300
+#define TIMEOUT_S      30
+
+struct port_state {
+	/** Sequence number of the next frame, only used by one worker. */
+	unsigned int next;
+	bool bad;
+};
+
+static struct port_state states[NUM_PORTS];
+static atomic_uint num_received;
+static int masters[NUM_PORTS];
+static int slaves[NUM_PORTS];
+
+static void check(bool condition, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (condition) {
+		return;
+	}
+
+	va_start(ap, fmt);
+	fputs("FAIL: ", stderr);
+	vfprintf(stderr, fmt, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+
+	exit(1);
+}
+
+static size_t make_frame(unsigned int port, unsigned int seq, uint8_t *data)
+{
+	const size_t length = (port * 7 + seq * 13) % MAX_FRAME_SIZE;
+
+	for (size_t i = 0; i < length; i++) {
+		data[i] = (port + seq + i) % 5 == 0 ? 0x00 : port * 31 + seq + i;
+	}
+
+	return length;
+}
+
+static void frame_cb(void *user_data, unsigned int port, const uint8_t *data, size_t length)
+{
+	uint8_t expected[MAX_FRAME_SIZE];
+	struct port_state *const state = &states[port];
+	const size_t expected_length = make_frame(port, state->next++, expected);
+
+	if (length != expected_length || memcmp(data, expected, length) != 0) {
+		state->bad = true;
+	}
+
+	atomic_fetch_add(&num_received, 1);
+}
+
+/* Writes the frames of all ports, each in two pieces, so the reads of the
+ * gateway end within frames.
+ */
+static void *writer_main(void *arg)
+{
+	static const uint8_t invalid[] = {0x03, 0x11, 0x00};
+	uint8_t too_long[MAX_FRAME_SIZE + 1];
+	uint8_t frame[MAX_FRAME_SIZE];
+	uint8_t encoded[COBS_MAX_ENCODED_SIZE(sizeof(too_long)) + 1];
+	size_t length;
+
+	memset(too_long, 0x11, sizeof(too_long));
+	length = cobs_encode(too_long, sizeof(too_long), encoded);
+	encoded[length++] = 0x00;
+	check(pty_write(slaves[0], invalid, sizeof(invalid)) == 0, "write");
+	check(pty_write(slaves[0], encoded, length) == 0, "write");
+
+	for (unsigned int seq = 0; seq < NUM_FRAMES; seq++) {
+		for (unsigned int port = 0; port < NUM_PORTS; port++) {
+			length = cobs_encode(frame, make_frame(port, seq, frame), encoded);
+			encoded[length++] = 0x00;
+
+			const size_t split = (seq * 17 + port) % length;
+
+			check(pty_write(slaves[port], encoded, split) == 0, "write");
+			check(pty_write(slaves[port], &encoded[split], length - split) == 0,
+			      "write");
+		}
+	}
+
+	return NULL;
+}
+
+static void *run_main(void *arg)
+{
+	return (void *)(intptr_t)gateway_run(arg);
+}
+
+static void wait_received(unsigned int expected)
+{
+	for (unsigned int i = 0; atomic_load(&num_received) < expected; i++) {
+		check(i < TIMEOUT_S * 100, "received %u of %u frames",
+		      atomic_load(&num_received), expected);
+		usleep(10000);
+	}
+}
+
+static struct gateway *create(unsigned int num_ports)
+{
+	const struct gateway_config config = {
+		.fds = masters,
+		.num_ports = num_ports,
+		.num_workers = 3,
+		.max_frame_size = MAX_FRAME_SIZE,
+		.read_size = 64,
+		.cb = frame_cb,
+	};
+	struct gateway *gateway;
+
+	memset(states, 0, sizeof(states));
+	atomic_store(&num_received, 0);
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		check(pty_open(&masters[i], &slaves[i]) == 0, "pty_open");
+	}
+
+	const int ret = gateway_create(&gateway, &config);
+
+	check(ret == 0, "gateway_create: %s", strerror(-ret));
+	return gateway;
+}
+
+static void test_frames(void)
+{
+	struct gateway *const gateway = create(NUM_PORTS);
+	struct gateway_stats stats;
+	pthread_t runner;
+	pthread_t writer;
+	void *ret;
+
+	pthread_create(&runner, NULL, run_main, gateway);
+	pthread_create(&writer, NULL, writer_main, NULL);
+	pthread_join(writer, NULL);
+
+	wait_received(NUM_PORTS * NUM_FRAMES);
+	gateway_stop(gateway);
+	pthread_join(runner, &ret);
+	check(ret == NULL, "gateway_run: %s", strerror(-(intptr_t)ret));
+
+	for (unsigned int i = 0; i < NUM_PORTS; i++) {
+		check(!states[i].bad && states[i].next == NUM_FRAMES, "frames of port %u", i);
+		close(slaves[i]);
+		close(masters[i]);
+	}
+
+	gateway_stats_get(gateway, &stats);
+	check(stats.frames == NUM_PORTS * NUM_FRAMES, "%llu frames",
+	      (unsigned long long)stats.frames);
+	check(stats.errors == 2, "%llu errors", (unsigned long long)stats.errors);
+	gateway_destroy(gateway);
+}
+
+/* The gateway returns by itself once all ports were closed. */
+static void test_end(void)
+{
+	const unsigned int num_ports = 4;
+	struct gateway *const gateway = create(num_ports);
+	static const uint8_t frame[] = {0x02, 0x11, 0x00};
+	pthread_t runner;
+	void *ret;
+
+	pthread_create(&runner, NULL, run_main, gateway);
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		check(pty_write(slaves[i], frame, sizeof(frame)) == 0, "write");
+	}
+
+	wait_received(num_ports);
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		close(slaves[i]);
+	}
+
+	pthread_join(runner, &ret);
+	check(ret == NULL, "gateway_run: %s", strerror(-(intptr_t)ret));
+
+	for (unsigned int i = 0; i < num_ports; i++) {
+		close(masters[i]);
+	}
+
+	gateway_destroy(gateway);
+}
+
+/* Ports opened with O_NONBLOCK are polled instead of reading them again and
+ * again while they have no data.
+ */
+static void test_nonblocking(void)
+{
+	struct gateway *const gateway = create(1);
+	static const uint8_t frame[] = {0x02, 0x11, 0x00};
+	struct gateway_stats stats;
+	pthread_t runner;
+	void *ret;
+
+	check(fcntl(masters[0], F_SETFL, fcntl(masters[0], F_GETFL) | O_NONBLOCK) == 0, "fcntl");
+	pthread_create(&runner, NULL, run_main, gateway);
+
+	usleep(100000);
+	check(pty_write(slaves[0], frame, sizeof(frame)) == 0, "write");
+	wait_received(1);
+
+	close(slaves[0]);
+	pthread_join(runner, &ret);
+	check(ret == NULL, "gateway_run: %s", strerror(-(intptr_t)ret));
+	close(masters[0]);
+
+	gateway_stats_get(gateway, &stats);
+	check(stats.syscalls < 10, "%llu calls of io_uring_enter",
+	      (unsigned long long)stats.syscalls);
+	gateway_destroy(gateway);
+}
+
+int main(void)
+{
+	/* A hanging gateway fails the test instead of blocking it. */
+	alarm(2 * TIMEOUT_S);
+
+	test_frames();
+	test_end();
+	test_nonblocking();
+
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: MIT */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/sys/util.h>
+#include <cobs/stream.h>
+#include <cobs/tx_queue.h>
+
+/* Value of `submitted` while the consumer is stopped. No message is queued
+ * then, so this never appears in the list.
+ */
+static sys_snode_t stopped_marker;
+
+#define STOPPED ((atomic_ptr_val_t)&stopped_marker)
+
+void cobs_tx_queue_init(struct cobs_tx_queue *queue)
+{
+	atomic_ptr_set(&queue->submitted, STOPPED);
+	queue->pending = NULL;
+	queue->encode = (struct cobs_encode){
+		.state = COBS_ENCODE_STATE_FINISHED,
+	};
+}
+
+bool cobs_tx_queue_submit(struct cobs_tx_queue *queue, struct net_buf *buf)
+{
+	atomic_ptr_val_t head;
+
+	do {
+		head = atomic_ptr_get(&queue->submitted);
+		buf->node.next = head == STOPPED ? NULL : head;
+	} while (!atomic_ptr_cas(&queue->submitted, head, &buf->node));
+
+	return head == STOPPED;
+}
+
+bool cobs_tx_queue_stop(struct cobs_tx_queue *queue)
+{
+	__ASSERT_NO_MSG(queue->pending == NULL &&
+			queue->encode.state == COBS_ENCODE_STATE_FINISHED);
+
+	if (atomic_ptr_cas(&queue->submitted, NULL, STOPPED)) {
+		return true;
+	}
+
+	/* Only the consumer stops itself, so this is either still the case or
+	 * a message was submitted.
+	 */
+	return atomic_ptr_get(&queue->submitted) == STOPPED;
+}
+
+static struct net_buf *next_message(struct cobs_tx_queue *queue)
+{
+	if (!queue->pending) {
+		/* Only the consumer stops itself, so if it's called anyway,
+		 * there's nothing to take and it stays stopped.
+		 */
+		if (atomic_ptr_get(&queue->submitted) == STOPPED) {
+			return NULL;
+		}
+
+		/* Take all submitted messages and reverse them into the order
+		 * they were submitted in.
+		 */
+		sys_snode_t *node = atomic_ptr_clear(&queue->submitted);
+
+		while (node) {
+			sys_snode_t *const next = node->next;
+
+			node->next = queue->pending;
+			queue->pending = node;
+			node = next;
+		}
+
+		if (!queue->pending) {
+			return NULL;
+		}
+	}
+
+	struct net_buf *const buf = CONTAINER_OF(queue->pending, struct net_buf, node);
+
+	queue->pending = queue->pending->next;
+	return buf;
+}
+
+size_t cobs_tx_queue_encode(struct cobs_tx_queue *queue, uint8_t *output, size_t output_size)
+{
+	size_t num_written = 0;
+
+	while (num_written < output_size) {
+		if (queue->encode.state == COBS_ENCODE_STATE_FINISHED) {
+			struct net_buf *const buf = next_message(queue);
+			if (!buf) {
+				break;
+			}
+
+			cobs_encode_stream_init(&queue->encode, buf);
+			net_buf_unref(buf);
+		}
+
+		num_written += cobs_encode_stream(&queue->encode, &output[num_written],
+						  output_size - num_written);
+
+		if (queue->encode.state == COBS_ENCODE_STATE_FINISHED) {
+			cobs_encode_stream_free(&queue->encode);
+		}
+	}
+
+	return num_written;
+}